@@ -0,0 +1,288 @@
+/// Navigation micro-benchmark of the sisfe target.
+///
+/// Builds a sisfeGeometry for every placement mode and column count, then times G4Navigator on a batch of
+/// random points (LocateGlobalPointAndSetup) and of straight rays tracked through the grid (ComputeStep and
+/// relocation), as tracking does. No physics and no run manager are involved. The "place" rows are the reference:
+/// one logical volume per pillar, as the grid was built before the other placement modes.
+///
+/// Build against Geant4, e.g.
+///     g++ -O2 -std=c++17 -Iinclude bench/musigNavBench.cpp src/musigSisfe.cpp src/musigSisfeParameterisation.cpp src/musigVisPalette.cpp
+///         src/musigGeometryArena.cpp
+///         $(geant4-config --cflags --libs) -o musigNavBench
+///
+/// Usage:
+///     musigNavBench [--placements place,param,replica,lattice] [--columns 10,100,1000] [--points N] [--rays N]
+///                   [--liqhe x,y,z] [--si x,y,z] [--seed S]
+/// dimensions in mm, defaults are those of mac/muStopping2024grid.mac
+
+#include "musigSisfe.h"
+
+#include <G4Box.hh>
+#include <G4LogicalVolume.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4PhysicalVolumeStore.hh>
+#include <G4SolidStore.hh>
+#include <G4GeometryManager.hh>
+#include <G4Navigator.hh>
+#include <G4NistManager.hh>
+#include <G4PVPlacement.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4PhysicalConstants.hh>
+#include <geomdefs.hh>
+#include <G4ios.hh>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+    typedef struct NavBenchConfig {
+        std::vector<std::string> placements{"place", "param", "replica", "lattice"};
+        std::vector<G4int> columns{10, 100, 1000};
+        G4int nPoints = 1000000;
+        G4int nRays = 10000;
+        G4ThreeVector sizeLiqHe{0.04 * mm, 28.999 * mm, 0.08 * mm};
+        G4ThreeVector sizeSi{0.01 * mm, 28.999 * mm, 0.08 * mm};
+        unsigned long seed = 12345;
+    } NavBenchConfig;
+
+
+    typedef struct NavBenchResult {
+        std::size_t nLogical = 0;
+        std::size_t nPhysical = 0;
+        G4double closeTime = 0.;   // ms to close (voxelise) the geometry
+        G4double locateTime = 0.;  // ns per LocateGlobalPointAndSetup from the world
+        G4double stepTime = 0.;    // ns per ComputeStep + relocation along a ray
+        G4double stepsPerRay = 0.;
+    } NavBenchResult;
+
+
+    // upper limit of steps of one ray, guards against a ray stuck on a surface
+    const G4int kMaxStepsPerRay = 1000000;
+
+
+    std::vector<std::string> SplitList(const std::string &list) {
+        std::vector<std::string> items;
+        std::istringstream is(list);
+        std::string item;
+        while (std::getline(is, item, ',')) {
+            if (!item.empty()) {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+
+    G4ThreeVector ParseVector(const std::string &list) {
+        const auto items = SplitList(list);
+        if (items.size() != 3) {
+            G4cout << "<><><><><> ERROR: expected x,y,z instead of " << list << G4endl;
+            exit(1);
+        }
+        return G4ThreeVector(std::stod(items[0]), std::stod(items[1]), std::stod(items[2])) * mm;
+    }
+
+
+    NavBenchConfig ParseArguments(int argc, char **argv) {
+        NavBenchConfig config;
+        for (int i = 1; i < argc; ++i) {
+            const std::string option = argv[i];
+            if (i + 1 >= argc) {
+                G4cout << "<><><><><> ERROR: missing value of option " << option << G4endl;
+                exit(1);
+            }
+            const std::string value = argv[++i];
+
+            if (option == "--placements") {
+                config.placements = SplitList(value);
+            } else if (option == "--columns") {
+                config.columns.clear();
+                for (const auto &item: SplitList(value)) {
+                    config.columns.push_back(std::stoi(item));
+                }
+            } else if (option == "--points") {
+                config.nPoints = std::stoi(value);
+            } else if (option == "--rays") {
+                config.nRays = std::stoi(value);
+            } else if (option == "--liqhe") {
+                config.sizeLiqHe = ParseVector(value);
+            } else if (option == "--si") {
+                config.sizeSi = ParseVector(value);
+            } else if (option == "--seed") {
+                config.seed = std::stoul(value);
+            } else {
+                G4cout << "<><><><><> ERROR: unknown option " << option << G4endl;
+                exit(1);
+            }
+        }
+        return config;
+    }
+
+
+    void ClearGeometry(MuSiG::sisfeGeometry &sisfe, MuSiG::GeometryArena &arena) {
+        // the registry of sisfe keeps the pillar volumes for the next grid, they go with the stores
+        sisfe.ForgetVolumes();
+        G4GeometryManager::GetInstance()->OpenGeometry();
+        G4PhysicalVolumeStore::GetInstance()->Clean();
+        G4LogicalVolumeStore::GetInstance()->Clean();
+        G4SolidStore::GetInstance()->Clean();
+        arena.Clear();
+    }
+
+
+    /// world holding one grid at its centre, returns the world and the half size of the grid container
+    G4VPhysicalVolume *BuildGeometry(MuSiG::sisfeGeometry &sisfe, const std::string &placement, G4int nColumns,
+                                     const NavBenchConfig &config, G4ThreeVector &halfGrid) {
+        const auto galactic = G4NistManager::Instance()->FindOrBuildMaterial("G4_Galactic");
+
+        auto sizeSi = config.sizeSi;
+        sisfe.SetPlacement(placement);
+        if (placement == "lattice") {
+            // square lattice of nColumns x nColumns posts of the Si column cross-section in X
+            const auto pitch = config.sizeSi.x() + config.sizeLiqHe.x();
+            sizeSi.setY(config.sizeSi.x());
+            sisfe.SetLattice(nColumns, nColumns, 1, pitch, pitch, "square");
+        }
+
+        // the world is made big enough for any grid and sized afterwards from the container
+        auto solidWorld = new G4Box("World", 1. * m, 1. * m, 1. * m);
+        auto logicWorld = new G4LogicalVolume(solidWorld, galactic, "World");
+        auto physiWorld = new G4PVPlacement(nullptr, G4ThreeVector(), logicWorld, "World", nullptr, false, 0, false);
+
+        sisfe.MakeGeometry(logicWorld, nColumns, config.sizeLiqHe.x(), config.sizeLiqHe.y(), config.sizeLiqHe.z(),
+                           sizeSi.x(), sizeSi.y(), sizeSi.z(), G4ThreeVector(), nullptr);
+
+        const auto container = sisfe.GetContainerDimensions();
+        halfGrid = G4ThreeVector(container.x / 2, container.y / 2, container.z / 2);
+        solidWorld->SetXHalfLength(halfGrid.x() + 1. * mm);
+        solidWorld->SetYHalfLength(halfGrid.y() + 1. * mm);
+        solidWorld->SetZHalfLength(halfGrid.z() + 1. * mm);
+
+        return physiWorld;
+    }
+
+
+    NavBenchResult Run(G4VPhysicalVolume *world, const G4ThreeVector &halfGrid, const NavBenchConfig &config) {
+        using clock = std::chrono::steady_clock;
+
+        NavBenchResult result;
+        result.nLogical = G4LogicalVolumeStore::GetInstance()->size();
+        result.nPhysical = G4PhysicalVolumeStore::GetInstance()->size();
+
+        auto start = clock::now();
+        G4GeometryManager::GetInstance()->CloseGeometry(true, false);
+        result.closeTime = std::chrono::duration<G4double, std::milli>(clock::now() - start).count();
+
+        G4Navigator navigator;
+        navigator.SetWorldVolume(world);
+
+        std::mt19937_64 engine(config.seed);
+        std::uniform_real_distribution<G4double> flat(-1., 1.);
+        auto randomPoint = [&]() {
+            return G4ThreeVector(flat(engine) * halfGrid.x(), flat(engine) * halfGrid.y(),
+                                 flat(engine) * halfGrid.z());
+        };
+        auto randomDirection = [&]() {
+            const auto cosTheta = flat(engine);
+            const auto sinTheta = std::sqrt(1. - cosTheta * cosTheta);
+            const auto phi = pi * flat(engine);
+            return G4ThreeVector(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+        };
+
+        // random points, every one located from the top of the tree
+        std::vector<G4ThreeVector> points(std::size_t(config.nPoints));
+        for (auto &point: points) {
+            point = randomPoint();
+        }
+
+        G4long found = 0;
+        start = clock::now();
+        for (const auto &point: points) {
+            found += (navigator.LocateGlobalPointAndSetup(point, nullptr, false) != nullptr);
+        }
+        const auto locateTime = std::chrono::duration<G4double, std::nano>(clock::now() - start).count();
+        result.locateTime = (config.nPoints > 0) ? locateTime / config.nPoints : 0.;
+        if (found != config.nPoints) {
+            G4cout << "<><><><><> WARNING: " << (config.nPoints - found) << " points not located" << G4endl;
+        }
+
+        // straight rays from a random point inside the grid until they leave the world
+        std::vector<std::pair<G4ThreeVector, G4ThreeVector>> rays(std::size_t(config.nRays));
+        for (auto &ray: rays) {
+            ray.first = randomPoint();
+            ray.second = randomDirection();
+        }
+
+        G4long nSteps = 0;
+        start = clock::now();
+        for (const auto &ray: rays) {
+            auto point = ray.first;
+            const auto &direction = ray.second;
+            navigator.LocateGlobalPointAndSetup(point, &direction, false, false);
+
+            for (G4int i = 0; i < kMaxStepsPerRay; ++i) {
+                G4double safety = 0.;
+                const auto step = navigator.ComputeStep(point, direction, kInfinity, safety);
+                if (step == kInfinity) {
+                    break;
+                }
+                point += step * direction;
+                navigator.SetGeometricallyLimitedStep();
+                ++nSteps;
+                if (!navigator.LocateGlobalPointAndSetup(point, &direction, true)) {
+                    break;
+                }
+            }
+        }
+        const auto stepTime = std::chrono::duration<G4double, std::nano>(clock::now() - start).count();
+        result.stepTime = (nSteps > 0) ? stepTime / G4double(nSteps) : 0.;
+        result.stepsPerRay = (config.nRays > 0) ? G4double(nSteps) / config.nRays : 0.;
+
+        return result;
+    }
+
+}
+
+
+int main(int argc, char **argv) {
+    const auto config = ParseArguments(argc, argv);
+
+    auto nist = G4NistManager::Instance();
+    nist->SetVerbose(0);
+    auto liqHe = new G4Material("sisfeLiqHe", 2, (4.0 * g / mole), (0.145 * g / cm3));
+
+    MuSiG::sisfeGeometry sisfe("NavBench");
+    sisfe.DefineMaterials(nist->FindOrBuildMaterial("G4_Galactic"), liqHe, nist->FindOrBuildMaterial("G4_Si"));
+    sisfe.SetCheckOverlaps(false);
+    MuSiG::GeometryArena arena;
+    sisfe.SetArena(&arena);
+
+    G4cout << std::setw(10) << "placement" << std::setw(10) << "columns" << std::setw(10) << "logical"
+           << std::setw(10) << "physical" << std::setw(12) << "close [ms]" << std::setw(14) << "locate [ns]"
+           << std::setw(12) << "step [ns]" << std::setw(12) << "steps/ray" << G4endl;
+
+    for (const auto &placement: config.placements) {
+        for (const auto nColumns: config.columns) {
+            G4ThreeVector halfGrid;
+            auto world = BuildGeometry(sisfe, placement, nColumns, config, halfGrid);
+            const auto result = Run(world, halfGrid, config);
+
+            G4cout << std::setw(10) << placement << std::setw(10) << nColumns << std::setw(10) << result.nLogical
+                   << std::setw(10) << result.nPhysical << std::setw(12) << std::fixed << std::setprecision(2)
+                   << result.closeTime << std::setw(14) << result.locateTime << std::setw(12) << result.stepTime
+                   << std::setw(12) << result.stepsPerRay << G4endl;
+
+            ClearGeometry(sisfe, arena);
+        }
+    }
+
+    return 0;
+}
@@ -2,8 +2,14 @@
 #define MUSIG_DETECTORCONSTRUCTION_H
 
 
+#include <deque>
+#include <map>
+#include <memory>
 #include <vector>
 #include <tuple>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <G4VUserDetectorConstruction.hh>
 #include <G4Box.hh>
@@ -11,15 +17,24 @@
 #include <G4Material.hh>
 #include <G4PVPlacement.hh>
 #include <G4UserLimits.hh>
+#include <G4ProductionCuts.hh>
+#include <G4Cache.hh>
 
 #include "musigDetectorMessenger.h"
 #include "musigSisfe.h"
+#include "musigGeometryProfiler.h"
+#include "musigGeometryDigest.h"
+#include "musigGeometryArena.h"
+#include "musigMaterialRegistry.h"
+#include "musigStoppingScorer.h"
 
 namespace MuSiG {
 
 
     class DetectorMessenger;
 
+    class TrackerSD;
+
 
     typedef struct DetVolume {
         G4LogicalVolume *logicVol = nullptr;
@@ -71,6 +86,39 @@ namespace MuSiG {
         G4String booltype;
     } DetBoxTubsDefinition;
 
+
+    typedef struct DetShapeDefinition {
+        G4String shape;            // box or tubs
+        DetBoxTubsDefinition params;
+    } DetShapeDefinition;
+
+    typedef struct DetRegionDefinition {
+        G4String name;
+        std::vector<G4String> volumes;     // root logical volumes of the region
+        G4double maxStep = 0.;             // 0 = no step limit in the region
+        G4double cut = 0.;                 // 0 = production cuts of the world
+        G4UserLimits *limits = nullptr;
+        G4ProductionCuts *cuts = nullptr;
+    } DetRegionDefinition;
+
+
+    typedef struct SisfeLatticeDefinition {
+        G4String name;
+        G4int nX = 0;
+        G4int nY = 0;
+        G4int nLayers = 1;
+        G4ThreeVector pitch;       // X and Y pitch of the lattice
+        G4String cell = "square";  // square or hex
+        G4String fill;             // material around the posts, empty for the sisfe LiqHe
+    } SisfeLatticeDefinition;
+
+    typedef struct SisfeColDefinition {
+        G4String ContainerCol;
+        G4String LiqHeCol;
+        G4String SiCol;
+        G4bool isInv=false;
+    } SisfeColDefinition;
+
     typedef struct SisfeGeometryDefinition {
         G4String name;
         G4int nLiqHe;
@@ -80,17 +128,15 @@ namespace MuSiG {
         G4ThreeVector rot;
         G4String mother;
         G4bool isPlaced=false;
+        G4String placement="place";
+        SisfeLatticeDefinition lattice;
+        G4String region;                   // region the grid container is the root of, empty for none
+        G4String matLiqHe = "LiqHe";       // materials of the grid, set by /setup/sisfeMaterials
+        G4String matSi = "G4_Si";
+        G4String matGap = "Galactic";      // container, gaps and cells
+        SisfeColDefinition colours;        // colours of this grid, the /setup/color/sisfe default if not set
     } SisfeGeometryDefinition;
 
-    typedef struct SisfeColDefinition {
-        G4String ContainerCol;
-        G4String LiqHeCol;
-        G4String SiCol;
-        G4bool isInv=false;
-    } SisfeColDefinition;
-
-    const G4int kMaxVolumes = 50;
-
     class DetectorConstruction : public G4VUserDetectorConstruction {
     public:
 
@@ -101,6 +147,8 @@ namespace MuSiG {
     public:
         G4VPhysicalVolume *Construct() override;
 
+        void ConstructSDandField() override;
+
         void SetMaxStep(G4double);
 
         void UpdateGeometry();
@@ -109,8 +157,12 @@ namespace MuSiG {
 
         void SetTubsDefinition(const DetBoxTubsDefinition &);
 
+        void ImportShapes(const G4String &);
+
         void SetDetDefinition(const G4String &);
 
+        void SetSisfeDetector(const G4String &, const G4String &);
+
         void SetRepDefinition(const DetReplica &);
 
         void SetColDefinition(const DetColDef &);
@@ -120,11 +172,94 @@ namespace MuSiG {
         void SetSmallStep(const DetMaxStepLength &);
 
         void SetSisfe(const SisfeGeometryDefinition &);
-        void SetSisfeColour(const SisfeColDefinition &);
+        void SetSisfeColour(const SisfeColDefinition &, const G4String &);
+        void SetSisfeMaterials(const G4String &, const G4String &, const G4String &, const G4String &);
+        void SetSisfeLattice(const SisfeLatticeDefinition &);
+        void SetSisfeRegion(const G4String &, const G4String &);
+
+        const SisfeGeometryDefinition *GetSisfe(const G4String &) const;
+
+        const DetShapeDefinition *GetShapeDefinition(const G4String &) const;
+
+        void AddStoppingVolume(const G4String &);
+
+        void SetStoppingSisfe(const G4String &, G4int, G4int, G4int);
+
+        void DefineMaterial(const MaterialDefinition &);
+
+        void LoadMaterials(const G4String &);
+
+        void ListMaterials() const;
+
+        void SetRegionVolume(const G4String &, const G4String &);
+
+        void SetRegionStep(const G4String &, G4double);
+
+        void SetRegionCut(const G4String &, G4double);
+
+        void SetProfiling(G4bool);
+
+        void SetOverlapMode(const G4String &);
+
+        void SetOverlapSamples(G4int);
+
+        void SetOverlapThreads(G4int);
+
+        void SetOverlapCache(const G4String &);
+
+        void SetCacheDirectory(const G4String &);
 
     private:
         void DefineMaterials();
 
+        void ConstructVolumes();
+
+        void ConstructShapes();
+
+        G4VSolid *MakeSolid(const DetShapeDefinition &);
+
+        void ConstructSisfe(const SisfeGeometryDefinition &, G4bool);
+
+        sisfeGeometry &SisfeGrid(const SisfeGeometryDefinition &);
+
+        G4bool IsSisfeSensitive(const G4String &) const;
+
+        void MarkSisfeVolume(const G4String &);
+
+        void ConstructAttributes();
+
+        G4bool RebuildChanged();
+
+        void OptimiseVolume(G4LogicalVolume *, G4bool, std::unordered_set<G4LogicalVolume *> &);
+
+        void ReleaseGeometry();
+
+        void SetShapeDefinition(const G4String &, const DetBoxTubsDefinition &);
+
+        void CheckShapeDefinition(const DetBoxTubsDefinition &);
+
+        void RegisterVolume(G4LogicalVolume *);
+
+        void RegisterTree(G4LogicalVolume *);
+
+        G4LogicalVolume *FindVolume(const G4String &);
+
+        std::vector<G4LogicalVolume *> SisfeVolumes(const G4String &);
+
+        std::vector<G4LogicalVolume *> VolumesNamed(const G4String &);
+
+        void ValidateOverlaps();
+
+        void AttachSensitiveDetector(G4LogicalVolume *, G4VSensitiveDetector *);
+
+        DetRegionDefinition &GetRegionDefinition(const G4String &);
+
+        void ConstructRegions();
+
+        void ReleaseRegions(const std::unordered_set<G4LogicalVolume *> *volumes = nullptr);
+
+        void AddToDigest(const G4String &, const DetBoxTubsDefinition &);
+
         G4Box *solidWorld = nullptr;
         G4LogicalVolume *logicWorld = nullptr;
         G4VPhysicalVolume *physiWorld = nullptr;
@@ -135,46 +270,77 @@ namespace MuSiG {
 
         G4ThreeVector fWorldLength;
 
-        sisfeGeometry sisfe;
+        // volumes of all the sisfe grids, shared by their geometry objects and the stopping scorers
+        std::shared_ptr<sisfeVolumeRegistry> fSisfeRegistry = std::make_shared<sisfeVolumeRegistry>();
+        // geometry object of every sisfe grid, made at its first build and released with the geometry
+        std::map<std::string, sisfeGeometry> fSisfeGrids;
+
+        GeometryProfiler fProfiler;
+
+        // digest of the /setup geometry definitions, identifies a geometry already validated
+        GeometryDigest fSetupDigest;
+
+        G4String fOverlapMode = "immediate";
+        G4int fOverlapSamples = 1000;
+        G4int fOverlapThreads = 0;
+        G4String fOverlapCache;
+
+        // directory of the GDML geometry cache, empty if not used
+        G4String fCacheDirectory;
        
+        // name -> logical volume of every volume made by the /setup commands, replaces the linear
+        // G4LogicalVolumeStore::GetVolume scans
+        std::unordered_map<std::string, G4LogicalVolume *> fVolumeIndex;
+
+        // /setup/box and /setup/tubs definitions, turned into solids and volumes at every build
+        std::deque<DetShapeDefinition> fShapeDefs;
+
+        // rotations and other non-store objects of the current build, released on rebuild
+        GeometryArena fArena;
+
+        // definitions changed since the last build, rebuilt in place by /setup/update; anything else
+        // (world, booleans, replicas) sets fFullRebuild
+        std::unordered_set<std::string> fDirtyVolumes;
+        std::unordered_set<std::string> fDirtySisfe;
+        G4bool fFullRebuild = true;
+
         std::vector<DetVolume> fVolumes;
         std::vector<DetReplica> fReplica;
         std::vector<DetBoolVolume> fBoolMothers;
         std::vector<DetBoolVolume> fBoolVolumes;
 
         std::vector<DetMaxStepLength> fSmallStep;
+        // G4UserLimits of the /setup/steplimit lengths, shared by the volumes and kept by the rebuilds
+        std::map<G4double, std::unique_ptr<G4UserLimits>> fStepLimits;
+
+        std::vector<DetRegionDefinition> fRegions;
 
         std::vector<DetColDef> fColors;
         std::vector<G4String> fDetName;
+        // logical volumes of fDetName, resolved on the master
+        std::vector<G4LogicalVolume *> fDetVolumes;
+
+        // sisfe grids and pillars (LiqHe, Si or all) of the sensitive detector, and their logical volumes resolved
+        // on the master: one per pillar type, or per pillar in the place mode, not shared with other grids
+        std::vector<std::pair<G4String, G4String>> fDetSisfe;
+        std::vector<G4LogicalVolume *> fDetSisfeVolumes;
+
+        // sensitive detector of each thread, made by ConstructSDandField
+        G4Cache<TrackerSD *> fTrackerSD;
+
+        // volumes and sisfe grids where muon stops are counted, all their logical volumes are resolved on the
+        // master for the scorers of the threads
+        std::vector<G4String> fStoppingVolumes;
+        std::vector<G4String> fStoppingGrids;
+        std::vector<G4LogicalVolume *> fStoppingLogicVolumes;
+        StoppingHistogramDefinition fStoppingHistogram;
+        G4Cache<StoppingScorer *> fStoppingSD;
 
         std::vector<SisfeGeometryDefinition> fSisfeParamsV;
         SisfeColDefinition fSisfeColParams;
 
-        G4Material *Vacuum = nullptr;
-        G4Material *LiqHe = nullptr;
-        G4Material *GasHe = nullptr;
-        G4Material *Copper = nullptr;
-        G4Material *CNTforest = nullptr;
-        G4Material *Mylar = nullptr;
-        G4Material *Plastic = nullptr;
-        G4Material *Titanium = nullptr;
-        G4Material *Aluminium = nullptr;
-        G4Material *Water = nullptr;
-        G4Material *Scintillator = nullptr;
-        G4Material *Berillium = nullptr;
-        G4Material *Lithium = nullptr;
-        G4Material *Silicon = nullptr;
-        G4Material *FusedSilica = nullptr;
-        G4Material *Aerogel = nullptr;
-        G4Material *CsI = nullptr;
-        G4Material *Lucite = nullptr;
-        G4Material *BGO = nullptr;
-        G4Material *Concrete = nullptr;
-        G4Material *Antico = nullptr;
-        G4Material *Beamvacuum = nullptr;
-        G4Material *Galactic = nullptr;
-        G4Material *Ar_gas = nullptr;
-        G4Material *SiM = nullptr;
+        // materials, built the first time a definition uses them
+        MaterialRegistry fMaterials;
     };
 
 
@@ -5,8 +5,12 @@
 #include <G4UImessenger.hh>
 #include <G4UIcmdWithADoubleAndUnit.hh>
 #include <G4UIcmdWithoutParameter.hh>
+#include <G4UIcmdWithABool.hh>
+#include <G4UIcmdWithAString.hh>
+#include <G4UIcmdWithAnInteger.hh>
 
 #include "musigDetectorConstruction.h"
+#include "musigGeometryScan.h"
 
 
 namespace MuSiG {
@@ -36,13 +40,60 @@ namespace MuSiG {
         G4UIcommand *fBoxDefCmd = nullptr;
         G4UIcommand *fRepDefCmd = nullptr;
         G4UIcommand *fDetDefCmd = nullptr;
+        G4UIdirectory *fDetDir = nullptr;
+        G4UIcommand *fDetSisfeCmd = nullptr;
         G4UIcommand *fColorDefCmd = nullptr;
         G4UIcommand *fColorSisfeDefCmd = nullptr;
         G4UIcommand *fStepDefCmd = nullptr;
         G4UIcommand *fSisfeDefCmd = nullptr;
+        G4UIcommand *fSisfeLatticeCmd = nullptr;
+        G4UIcommand *fSisfeMaterialsCmd = nullptr;
 
         G4UIcmdWithoutParameter *fUpdateCmd = nullptr;
 
+        G4UIcmdWithABool *fProfileCmd = nullptr;
+
+        G4UIdirectory *fOverlapsDir = nullptr;
+        G4UIcmdWithAString *fOverlapModeCmd = nullptr;
+        G4UIcmdWithAnInteger *fOverlapSamplesCmd = nullptr;
+        G4UIcmdWithAnInteger *fOverlapThreadsCmd = nullptr;
+        G4UIcmdWithAString *fOverlapCacheCmd = nullptr;
+
+        G4UIcmdWithAString *fGeometryCacheCmd = nullptr;
+
+        G4UIcommand *fCompileCmd = nullptr;
+        G4UIcmdWithAString *fLoadCmd = nullptr;
+        G4UIcmdWithAString *fImportCmd = nullptr;
+
+        G4UIdirectory *fMaterialDir = nullptr;
+        G4UIcommand *fMaterialElementCmd = nullptr;
+        G4UIcommand *fMaterialSimpleCmd = nullptr;
+        G4UIcommand *fMaterialCompoundCmd = nullptr;
+        G4UIcommand *fMaterialMixtureCmd = nullptr;
+        G4UIcmdWithAString *fMaterialLoadCmd = nullptr;
+        G4UIcmdWithoutParameter *fMaterialListCmd = nullptr;
+
+        G4UIdirectory *fRegionDir = nullptr;
+        G4UIcommand *fRegionAddCmd = nullptr;
+        G4UIcommand *fRegionStepCmd = nullptr;
+        G4UIcommand *fRegionCutCmd = nullptr;
+        G4UIcommand *fRegionSisfeCmd = nullptr;
+
+        G4UIdirectory *fStoppingDir = nullptr;
+        G4UIcmdWithAString *fStoppingVolumeCmd = nullptr;
+        G4UIcommand *fStoppingSisfeCmd = nullptr;
+        G4UIcmdWithoutParameter *fStoppingPrintCmd = nullptr;
+        G4UIcmdWithAString *fStoppingWriteCmd = nullptr;
+        G4UIcmdWithoutParameter *fStoppingResetCmd = nullptr;
+
+        GeometryScan *fScan = nullptr;
+        G4UIdirectory *fScanDir = nullptr;
+        G4UIcommand *fScanParameterCmd = nullptr;
+        G4UIcmdWithAnInteger *fScanEventsCmd = nullptr;
+        G4UIcmdWithAString *fScanOutputCmd = nullptr;
+        G4UIcmdWithAString *fScanOutputCommandCmd = nullptr;
+        G4UIcmdWithoutParameter *fScanRunCmd = nullptr;
+
     };
 
 
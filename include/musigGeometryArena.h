@@ -0,0 +1,65 @@
+#ifndef MUSIG_GEOMETRYARENA_H
+#define MUSIG_GEOMETRYARENA_H
+
+
+#include <deque>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <globals.hh>
+#include <G4RotationMatrix.hh>
+#include <G4ThreeVector.hh>
+
+
+namespace MuSiG {
+
+
+    /// Owner of the objects allocated while one geometry is built that are not held by the G4 stores
+    /// (rotation matrices, parameterisations, ...). Rotations live in a chunked pool, everything else
+    /// is kept with its deleter. Clear() releases the whole build at once, in reverse order of creation,
+    /// before the geometry is rebuilt; the objects of volumes removed by an incremental rebuild are given
+    /// back one by one, so repeated updates do not grow the arena.
+    class GeometryArena {
+    public:
+
+        GeometryArena() = default;
+
+        GeometryArena(const GeometryArena &) = delete;
+
+        GeometryArena &operator=(const GeometryArena &) = delete;
+
+        ~GeometryArena();
+
+        /// rotation by the given angles (in deg) around X, then Y, then Z
+        G4RotationMatrix *MakeRotation(const G4ThreeVector &anglesDeg);
+
+        template<typename T, typename... Args>
+        T *Make(Args &&... args) {
+            auto object = new T(std::forward<Args>(args)...);
+            fObjects.emplace_back(object, [](void *p) { delete static_cast<T *>(p); });
+            return object;
+        }
+
+        /// deletes an object made by Make(), nothing if it was not
+        void Release(const void *object);
+
+        /// returns a rotation of MakeRotation() to the pool, nothing for any other rotation
+        void ReleaseRotation(G4RotationMatrix *rot);
+
+        void Clear();
+
+        std::size_t Size() const { return fRotationsInUse.size() + fObjects.size(); }
+
+    private:
+        std::deque<G4RotationMatrix> fRotations;
+        std::unordered_set<const G4RotationMatrix *> fRotationsInUse;
+        std::vector<G4RotationMatrix *> fFreeRotations;
+        std::vector<std::pair<void *, void (*)(void *)>> fObjects;
+    };
+
+
+}
+
+
+#endif
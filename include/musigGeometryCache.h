@@ -0,0 +1,36 @@
+#ifndef MUSIG_GEOMETRYCACHE_H
+#define MUSIG_GEOMETRYCACHE_H
+
+
+#include <globals.hh>
+#include <G4VPhysicalVolume.hh>
+
+
+namespace MuSiG {
+
+
+    /// On-disk cache of the constructed volume tree, stored as GDML and named after the digest of the
+    /// /setup geometry definitions. Sensitive detectors, vis attributes and step limits are not part of GDML,
+    /// they are applied again after loading.
+    class GeometryCache {
+    public:
+
+        /// false if Geant4 was built without GDML support
+        static G4bool IsAvailable();
+
+        static G4String FileName(const G4String &directory, const G4String &digest);
+
+        static G4bool Exists(const G4String &fileName);
+
+        /// reads the world from fileName, nullptr on failure
+        static G4VPhysicalVolume *Load(const G4String &fileName);
+
+        /// writes world to fileName through a temporary file, so that concurrent jobs never read a partial file
+        static void Store(const G4String &fileName, G4VPhysicalVolume *world);
+    };
+
+
+}
+
+
+#endif
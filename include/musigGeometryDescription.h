@@ -0,0 +1,45 @@
+#ifndef MUSIG_GEOMETRYDESCRIPTION_H
+#define MUSIG_GEOMETRYDESCRIPTION_H
+
+
+#include <globals.hh>
+
+#include "musigDetectorConstruction.h"
+
+
+namespace MuSiG {
+
+
+    /// Compiled geometry description: a /setup macro turned into typed binary records by /setup/compile and fed
+    /// to the DetectorConstruction by /setup/load, without the parsing and dispatch of the UI commands.
+    ///
+    /// /setup/box, /setup/tubs, /setup/replica, /setup/sisfe and /setup/sisfeLattice become records of their
+    /// definition, with the units already applied. Any other command (materials, colours, detectors, ...) is kept
+    /// as a command line, with the default values of its omitted parameters, and applied through the UI manager
+    /// at its place in the sequence. Macros called with /control/execute are compiled inline; aliases are not
+    /// resolved at compile time, so a line using one is an error.
+    ///
+    /// The argument parsers are shared with the DetectorMessenger, so a compiled macro gives the same definitions
+    /// as the macro itself.
+    class GeometryDescription {
+    public:
+
+        /// arguments of /setup/box and /setup/tubs
+        static DetBoxTubsDefinition ParseShape(const G4String &args);
+
+        static DetReplica ParseReplica(const G4String &args);
+
+        static SisfeGeometryDefinition ParseSisfe(const G4String &args);
+
+        static SisfeLatticeDefinition ParseSisfeLattice(const G4String &args);
+
+        static void Compile(const G4String &macroFile, const G4String &fileName);
+
+        static void Load(const G4String &fileName, DetectorConstruction *detector);
+    };
+
+
+}
+
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef MUSIG_GEOMETRYDIGEST_H
+#define MUSIG_GEOMETRYDIGEST_H
+
+
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include <globals.hh>
+#include <G4ThreeVector.hh>
+
+
+namespace MuSiG {
+
+
+    /// 64 bit FNV-1a digest of the geometry definitions, used to recognise a geometry that was already built
+    /// or validated.
+    class GeometryDigest {
+    public:
+
+        void Reset() { fHash = kOffset; }
+
+        void Add(const G4String &value) {
+            for (const auto c: value) {
+                Mix(static_cast<unsigned char>(c));
+            }
+            Mix(0);
+        }
+
+        void Add(const char *value) { Add(G4String(value)); }
+
+        void Add(G4double value) {
+            unsigned char bytes[sizeof(G4double)];
+            std::memcpy(bytes, &value, sizeof(G4double));
+            for (const auto b: bytes) {
+                Mix(b);
+            }
+        }
+
+        void Add(G4int value) { Add(G4double(value)); }
+
+        void Add(G4bool value) { Mix(value ? 1 : 0); }
+
+        void Add(const G4ThreeVector &value) {
+            Add(value.x());
+            Add(value.y());
+            Add(value.z());
+        }
+
+        std::uint64_t Value() const { return fHash; }
+
+        G4String Hex() const {
+            std::ostringstream os;
+            os << std::hex << std::setw(16) << std::setfill('0') << fHash;
+            return os.str();
+        }
+
+    private:
+        static constexpr std::uint64_t kOffset = 14695981039346656037ULL;
+        static constexpr std::uint64_t kPrime = 1099511628211ULL;
+
+        void Mix(unsigned char byte) {
+            fHash ^= byte;
+            fHash *= kPrime;
+        }
+
+        std::uint64_t fHash = kOffset;
+    };
+
+
+}
+
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef MUSIG_GEOMETRYPROFILER_H
+#define MUSIG_GEOMETRYPROFILER_H
+
+
+#include <chrono>
+#include <vector>
+
+#include <globals.hh>
+
+
+namespace MuSiG {
+
+
+    typedef struct GeoPhaseRecord {
+        G4String name;
+        G4double time = 0.;       // wall time in ms
+        G4long nSolids = 0;       // solids created during the phase
+        G4long nLogical = 0;      // logical volumes created during the phase
+        G4long nPhysical = 0;     // physical volumes created during the phase
+        G4long rssDelta = 0;      // resident memory growth in kB, 0 if not available
+    } GeoPhaseRecord;
+
+
+    /// Opt-in timing of the phases of DetectorConstruction::Construct(), switched on with /setup/profile.
+    /// Every phase records its wall time, the growth of the G4 solid/logical/physical volume stores and
+    /// the growth of the resident memory of the process.
+    class GeometryProfiler {
+    public:
+
+        void SetEnabled(G4bool enabled) { fEnabled = enabled; }
+
+        G4bool IsEnabled() const { return fEnabled; }
+
+        void Reset();
+
+        void BeginPhase(const G4String &name);
+
+        void EndPhase();
+
+        void PrintSummary() const;
+
+    private:
+        static G4long ResidentMemory();
+
+        G4bool fEnabled = false;
+        G4bool fOpen = false;
+
+        std::vector<GeoPhaseRecord> fPhases;
+
+        GeoPhaseRecord fCurrent;
+        std::chrono::steady_clock::time_point fStart;
+        G4long fSolids0 = 0;
+        G4long fLogical0 = 0;
+        G4long fPhysical0 = 0;
+        G4long fRss0 = 0;
+    };
+
+
+}
+
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef MUSIG_GEOMETRYSCAN_H
+#define MUSIG_GEOMETRYSCAN_H
+
+
+#include <vector>
+
+#include <globals.hh>
+
+
+namespace MuSiG {
+
+
+    class DetectorConstruction;
+
+
+    typedef struct GeoScanParameter {
+        G4String kind;       // sisfe, box, tubs, or ui for any other UI command
+        G4String name;       // name of the grid or volume, the command for ui
+        G4String field;      // e.g. sizeSi.z, pos.x, nLiqHe; ignored for ui
+        G4double from = 0.;  // in unit
+        G4double to = 0.;
+        G4double step = 0.;
+        G4String unit;       // length unit, deg for rotations, - for none
+    } GeoScanParameter;
+
+
+    typedef struct GeoScanPoint {
+        G4int index = 0;
+        G4double value = 0.;
+        G4double buildTime = 0.;  // ms to rebuild the geometry, of the master under MT
+        G4double runTime = 0.;    // ms to run the events
+    } GeoScanPoint;
+
+
+    /// Parameter scan over one field of a /setup definition (or the value of a UI command such as /gun/momentum),
+    /// driven by /setup/scan/. At every point the definition is changed through the DetectorConstruction setters,
+    /// the geometry is rebuilt as by /setup/update (only the changed volumes when possible), the per-point output
+    /// file is set and the events are run, all in the same process so materials and physics tables are made once.
+    class GeometryScan {
+    public:
+
+        explicit GeometryScan(DetectorConstruction *detector) : fDetector(detector) {}
+
+        void SetParameter(const GeoScanParameter &);
+
+        void SetEvents(G4int events) { fEvents = events; }
+
+        void SetOutput(const G4String &prefix) { fOutputPrefix = prefix; }
+
+        void SetOutputCommand(const G4String &command) { fOutputCommand = command; }
+
+        void Run();
+
+    private:
+        void Apply(G4double value);
+
+        static G4bool IsValidField(const G4String &kind, const G4String &field);
+
+        static G4bool IsLength(const G4String &field);
+
+        DetectorConstruction *fDetector = nullptr;
+
+        GeoScanParameter fParameter;
+        G4bool fHasParameter = false;
+
+        G4int fEvents = 0;
+        G4String fOutputPrefix;
+        G4String fOutputCommand = "/run/outputFilename";
+
+        std::vector<GeoScanPoint> fPoints;
+    };
+
+
+}
+
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef MUSIG_HITCOLUMNS_H
+#define MUSIG_HITCOLUMNS_H
+
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <globals.hh>
+#include <G4ThreeVector.hh>
+
+
+namespace MuSiG {
+
+
+    /// Columnar binary hit output. The hits are kept as one array per field (struct of arrays) and written
+    /// in blocks of a fixed number of hits, every column of a block compressed on its own with zlib, so a
+    /// reader decompresses only the columns it asks for (e.g. the stopping positions).
+    ///
+    /// File layout (little endian, as written by the host):
+    ///     "MSHC", version, number of columns
+    ///     blocks: number of hits (0 ends the file), volume names first used in the block,
+    ///             then for every column its compressed and raw size, then the compressed columns
+    /// Volume IDs are indices of the volume names in the order they first appear in the file.
+
+
+    enum class HitColumn : std::uint32_t {
+        EventID = 0,     // int32
+        VolumeID,        // int32, index of the volume name
+        CopyNo,          // int32
+        X,               // double, mm
+        Y,
+        Z,
+        Edep,            // double, keV
+        Time,            // double, ns
+        Count
+    };
+
+
+    typedef struct HitRecord {
+        G4int eventID = 0;
+        G4String volume;
+        G4int copyNo = 0;
+        G4ThreeVector pos;        // G4 internal units
+        G4double edep = 0.;
+        G4double time = 0.;
+    } HitRecord;
+
+
+    class HitColumnWriter {
+    public:
+
+        explicit HitColumnWriter(std::size_t blockSize = 65536) : fBlockSize(blockSize) {}
+
+        HitColumnWriter(const HitColumnWriter &) = delete;
+
+        HitColumnWriter &operator=(const HitColumnWriter &) = delete;
+
+        ~HitColumnWriter();
+
+        void Open(const G4String &fileName);
+
+        void Add(const HitRecord &hit);
+
+        /// writes the last block and the end of the file
+        void Close();
+
+        G4bool IsOpen() const { return fFile.is_open(); }
+
+    private:
+        void WriteBlock();
+
+        G4int VolumeID(const G4String &volume);
+
+        std::size_t fBlockSize;
+        std::ofstream fFile;
+
+        std::array<std::vector<std::int32_t>, 3> fInts;
+        std::array<std::vector<G4double>, 5> fDoubles;
+
+        std::unordered_map<std::string, G4int> fVolumes;
+        std::vector<G4String> fNewVolumes;
+    };
+
+
+    class HitColumnReader {
+    public:
+
+        void Open(const G4String &fileName);
+
+        /// reads the next block, decompressing only the columns given; false at the end of the file, a truncated or
+        /// corrupted file is an error
+        G4bool ReadBlock(const std::vector<HitColumn> &columns);
+
+        std::size_t GetRows() const { return fRows; }
+
+        /// column of the last block read, empty if it was not asked for
+        const std::vector<std::int32_t> &GetInts(HitColumn) const;
+
+        const std::vector<G4double> &GetDoubles(HitColumn) const;
+
+        const G4String &GetVolumeName(G4int volumeID) const { return fVolumeNames.at(std::size_t(volumeID)); }
+
+    private:
+        std::ifstream fFile;
+        std::uint32_t fColumns = 0;
+        std::size_t fRows = 0;
+
+        std::array<std::vector<std::int32_t>, 3> fInts;
+        std::array<std::vector<G4double>, 5> fDoubles;
+
+        std::vector<G4String> fVolumeNames;
+        std::vector<unsigned char> fBuffer;
+    };
+
+
+}
+
+
+#endif
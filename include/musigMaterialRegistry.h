@@ -0,0 +1,92 @@
+#ifndef MUSIG_MATERIALREGISTRY_H
+#define MUSIG_MATERIALREGISTRY_H
+
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <globals.hh>
+#include <G4Material.hh>
+#include <G4Element.hh>
+
+
+namespace MuSiG {
+
+
+    /// element, simple (one element), compound (atoms per molecule) or mixture (mass fractions of materials
+    /// or elements) given by /setup/material/ or a material database file
+    typedef struct MaterialDefinition {
+        G4String kind;
+        G4String name;
+        G4String symbol;                  // element only
+        G4double z = 0.;                  // element and simple
+        G4double a = 0.;                  // element and simple, molar mass
+        G4double density = 0.;
+        G4State state = kStateUndefined;
+        G4double temperature = 0.;        // 0 = NTP
+        G4double pressure = 0.;           // 0 = 1 atm
+        std::vector<std::pair<G4String, G4double>> components;
+    } MaterialDefinition;
+
+
+    /// Named material and element factories, run the first time a material is requested, so only the materials
+    /// used by the geometry get physics tables at /run/initialize. A material already in the material table (e.g.
+    /// read from the GDML geometry cache) is taken from there, other names without a factory are built from the
+    /// NIST database (G4_...). Definitions only check the names with Has(), the geometry construction builds them.
+    class MaterialRegistry {
+    public:
+
+        typedef std::function<G4Material *()> MaterialFactory;
+        typedef std::function<G4Element *()> ElementFactory;
+
+        void Register(const G4String &name, MaterialFactory factory) { fFactories[name] = std::move(factory); }
+
+        void RegisterElement(const G4String &name, ElementFactory factory) {
+            fElementFactories[name] = std::move(factory);
+        }
+
+        /// registers the factory of a user defined material or element, an error if a material of that name
+        /// was already built
+        void Define(const MaterialDefinition &);
+
+        /// definition from the arguments of /setup/material/<kind>, e.g. for a compound
+        /// "name density unit state temperature pressure unit comp1 n1 comp2 n2 ..."
+        static MaterialDefinition Parse(const G4String &kind, const G4String &arguments);
+
+        /// definitions of a material database file, one "<kind> <arguments>" per line, # for comments
+        static std::vector<MaterialDefinition> ReadDatabase(const G4String &fileName);
+
+        /// material of that name, built on first use; nullptr if unknown
+        G4Material *Get(const G4String &name);
+
+        /// true if Get would find or build a material of that name, without building it
+        G4bool Has(const G4String &name) const;
+
+        G4Element *GetElement(const G4String &name);
+
+        std::vector<G4String> GetNames() const;
+
+        /// name and density of the materials built so far
+        void PrintBuilt() const;
+
+    private:
+        static G4State ParseState(const G4String &);
+
+        G4Material *Build(const MaterialDefinition &);
+
+        std::unordered_map<std::string, MaterialFactory> fFactories;
+        std::unordered_map<std::string, ElementFactory> fElementFactories;
+
+        std::unordered_map<std::string, G4Material *> fMaterials;
+        std::unordered_map<std::string, G4Element *> fElements;
+        std::vector<G4Material *> fBuilt;
+    };
+
+
+}
+
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef MUSIG_OVERLAPVALIDATOR_H
+#define MUSIG_OVERLAPVALIDATOR_H
+
+
+#include <vector>
+
+#include <globals.hh>
+#include <G4VPhysicalVolume.hh>
+
+
+namespace MuSiG {
+
+
+    /// Overlap check of a whole volume tree run after construction, used when the placements were made without
+    /// pSurfChk, with the tests of G4PVPlacement::CheckOverlaps. The surface points of every placement are drawn
+    /// on the calling thread, in the order of the tree; the worker threads only test them against the solids of
+    /// the mother and siblings (const Inside and DistanceToIn/Out), so the result is the same for any number of
+    /// threads and nothing is printed or raised outside the calling thread. Parameterised placements are checked
+    /// on the calling thread with CheckOverlaps, replicas are not checked.
+    class OverlapValidator {
+    public:
+
+        void SetSamples(G4int samples) { fSamples = samples; }
+
+        void SetThreads(G4int threads) { fThreads = threads; }
+
+        /// checks every daughter below world and returns the number of overlapping placements
+        G4int Validate(G4VPhysicalVolume *world);
+
+        const std::vector<G4VPhysicalVolume *> &GetOverlapping() const { return fOverlapping; }
+
+        /// true if digest is listed in the validated geometries file
+        static G4bool IsValidated(const G4String &cacheFile, const G4String &digest);
+
+        /// appends digest to the validated geometries file
+        static void MarkValidated(const G4String &cacheFile, const G4String &digest);
+
+    private:
+        /// 1 if one of the fSamples points (in the mother frame) of pv is outside its mother or inside a sibling,
+        /// whose name is put in other
+        G4int Check(G4VPhysicalVolume *pv, const G4ThreeVector *points, G4String &other) const;
+
+        G4int fSamples = 1000;
+        G4int fThreads = 0;     // 0 = one thread per core
+
+        std::vector<G4VPhysicalVolume *> fOverlapping;
+    };
+
+
+}
+
+
+#endif
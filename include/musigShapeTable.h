@@ -0,0 +1,34 @@
+#ifndef MUSIG_SHAPETABLE_H
+#define MUSIG_SHAPETABLE_H
+
+
+#include <vector>
+
+#include <globals.hh>
+
+#include "musigDetectorConstruction.h"
+
+
+namespace MuSiG {
+
+
+    /// Reader of a table of boxes and tubs for /setup/import, one component per line with the fields of
+    /// /setup/box and /setup/tubs preceded by the shape, comma (CSV) or tab (TSV) separated:
+    ///
+    ///     shape,name,material,sizeX,sizeY,sizeZ,sizeUnit,posX,posY,posZ,posUnit,rotX,rotY,rotZ,mother[,booltype]
+    ///
+    /// shape is box or tubs (sizes rmin, rmax, length for tubs), rotations in deg, booltype A if omitted. Empty
+    /// lines and lines starting with # are skipped, as is a first line starting with "shape" (a header). The file
+    /// is memory mapped and read in one pass.
+    class ShapeTable {
+    public:
+
+        /// definitions in the order of the file, materials are not looked up here
+        static std::vector<DetShapeDefinition> Read(const G4String &fileName);
+    };
+
+
+}
+
+
+#endif
@@ -2,6 +2,13 @@
 #define SISFE_H
 
 #include <iostream>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include <G4Material.hh>
 #include <G4Box.hh>
 #include <G4LogicalVolume.hh>
@@ -9,9 +16,18 @@
 #include <G4SystemOfUnits.hh>
 #include <G4NistManager.hh>
 #include <G4PVPlacement.hh>
+#include <G4PVParameterised.hh>
+#include <G4PVReplica.hh>
 #include <G4VisAttributes.hh>
 #include <G4RotationMatrix.hh>
 #include <G4Colour.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4Region.hh>
+#include <G4VTouchable.hh>
+
+#include "musigSisfeParameterisation.h"
+#include "musigVisPalette.h"
+#include "musigGeometryArena.h"
 
 namespace MuSiG {
 
@@ -25,6 +41,73 @@ struct ThreeDimensions{
 
 };
 
+// kind of sisfe volume a point is in, Gap for the vacuum or fill around the pillars
+enum class sisfeVolumeType
+{
+    None,
+    Container,
+    Si,
+    LiqHe,
+    Gap
+};
+
+// pillar of a sisfe grid a point belongs to, see sisfeGeometry::Identify
+struct sisfePillarId
+{
+    sisfeVolumeType type = sisfeVolumeType::None;
+    G4int column = -1;    // Si walls 0..nLiqHe, LiqHe column i between the Si walls i and i+1; cell along X for a lattice
+    G4int row = 0;        // lattice only: row of posts along Y
+    G4int layer = 0;      // lattice only: layer along Z
+    G4double localX = 0.; // X of the point from the centre of the pillar (of the gap or cell for Gap)
+    G4String grid;        // name ID of the grid, a pillar volume may be shared by several grids
+};
+
+// shape of a registered grid, enough to turn the copy numbers of a touchable into a column
+struct sisfeGridShape
+{
+    G4String nameID;
+    G4String placement = "place";
+    const G4LogicalVolume *container = nullptr;
+    G4int nLiqHe = 0;
+    G4double worldDimX = 0.;
+    G4double SiDimX = 0.;
+    G4double pitch = 0.;
+    G4bool hex = false;
+};
+
+// what two grids need in common to share a pillar volume: type, dimensions, material, colour, region of the grid and
+// mother of the container (the region a grid without its own inherits)
+typedef std::tuple<sisfeVolumeType, G4double, G4double, G4double, const G4Material *, const G4VisAttributes *, const G4Region *, const G4LogicalVolume *> sisfePillarKey;
+
+// volumes of the sisfe grids of a geometry, shared by their sisfeGeometry objects: the type and grid of every volume
+// for Identify, and the pillar volumes a grid may reuse instead of making its own
+class sisfeVolumeRegistry
+{
+public:
+    // registers the volumes below container, classified by the suffix of their names so that a pillar volume made by
+    // another grid is found as well
+    void Register(G4LogicalVolume *container);
+    void Forget(const G4LogicalVolume *logic);
+    void Clear();
+
+    sisfePillarId Identify(const G4VTouchable *touchable, const G4ThreeVector &globalPosition) const;
+
+    // true for a pillar volume placed in more than one grid
+    G4bool IsShared(const G4LogicalVolume *logic) const;
+
+    // pillar volume made by a grid for these properties, nullptr if none
+    G4LogicalVolume *FindPillar(const sisfePillarKey &key) const;
+    void AddPillar(const sisfePillarKey &key, G4LogicalVolume *logic);
+
+private:
+    std::unordered_map<const G4LogicalVolume *, sisfeVolumeType> m_types;
+    // container -> shape of its grid
+    std::unordered_map<const G4LogicalVolume *, sisfeGridShape> m_grids;
+    // pillar volume -> containers of the grids it is placed in
+    std::unordered_map<const G4LogicalVolume *, std::unordered_set<const G4LogicalVolume *>> m_users;
+    std::map<sisfePillarKey, G4LogicalVolume *> m_pillars;
+};
+
 class sisfeGeometry
 {
 public:
@@ -40,12 +123,22 @@ public:
     void MakeGeometry(G4LogicalVolume *, G4String ,G4int nLiqHe, G4double LiqHeDimX, G4double LiqHeDimY, G4double LiqHeDimZ, G4double SiDimX, G4double SiDimY, G4double SiDimZ, G4ThreeVector position, G4RotationMatrix *rot);
 
     void SetNameID(G4String);
+    void SetPlacement(G4String placement);
+    void SetCheckOverlaps(G4bool checkOverlaps);
+    // owner of the objects of a build not held by the G4 stores (parameterisations), none if not set
+    void SetArena(GeometryArena *arena);
+    void SetLattice(G4int nX, G4int nY, G4int nLayers, G4double pitchX, G4double pitchY, G4String cell);
+    void SetFillMaterial(G4Material *fill);
+    void SetRegion(G4Region *region);
+    void ApplyRegion();
     void SetContainerColour(G4String colorContainer);
     void SetLiqHeColour(G4String colorLiqHe);
     void SetSiColour(G4String colorSi);
     void SetColours(G4String colorContainer, G4String colorLiqHe, G4String colorSi);
+    void ApplyColours();
 
     const G4String GetNameID();
+    const G4String GetPlacement();
     const G4String GetNameSolidContainer();
     const G4String GetNameSolidLiqHe();
     const G4String GetNameSolidSi();
@@ -67,6 +160,30 @@ public:
     const G4LogicalVolume* GetLogicalContainer();
     const G4LogicalVolume* GetLogicalLiqHe();
     const G4LogicalVolume* GetLogicalSi();
+    // every logical volume of the grid built by the last MakeGeometry
+    std::vector<G4LogicalVolume*> GetLogicalVolumes();
+    // names of the logical volumes a grid named nameID may have, whatever its placement
+    static std::vector<G4String> GetLogicalVolumeNames(const G4String &nameID);
+
+    // pillar of the point of a touchable (e.g. the pre-step point in a sensitive detector) in any grid registered in
+    // the registry of this object, type None if the volume is not part of one. Two hash lookups and the copy numbers
+    // of the touchable, whatever the number of columns and the placement mode.
+    sisfePillarId Identify(const G4VTouchable *touchable, const G4ThreeVector &globalPosition) const;
+    // registers the volumes of the grid under container for Identify; done by MakeGeometry, needed for a grid not
+    // built by this object (e.g. read from GDML)
+    void RegisterVolumes(G4LogicalVolume *container);
+    // forget volumes about to be deleted
+    void ForgetVolume(const G4LogicalVolume *logic);
+    void ForgetVolumes();
+    // true for a pillar volume placed in more than one grid, it cannot be deleted with one of them
+    G4bool IsShared(const G4LogicalVolume *logic) const;
+    // use a registry held by the owner of several grids: their grids are identified by any of them and share their
+    // pillar volumes
+    void SetRegistry(std::shared_ptr<sisfeVolumeRegistry> registry);
+    // reuse the pillar volumes of the grids of the registry with the same dimensions, materials, colours, region and
+    // mother (default), or make new ones for this grid only (e.g. for a grid with a sensitive detector); the "place"
+    // mode always makes a volume per pillar
+    void SetSharePillars(G4bool share);
 
     const G4VPhysicalVolume* GetPhysicalVolumeContainer();
     const G4VPhysicalVolume* GetPhysicalVolumeLiqHe();
@@ -76,7 +193,17 @@ public:
 
 private:
     void Geometry(G4LogicalVolume *logicWorld);
-    G4VisAttributes* ifColors(G4String color);
+    void PlacePillars();
+    void ParameterisePillars();
+    void ReplicateCells();
+    void BuildLattice();
+    const G4VisAttributes* ifColors(G4String color);
+    // Si or LiqHe pillar volume, taken from the registry if a grid already made one with the same properties
+    G4LogicalVolume *PillarVolume(sisfeVolumeType type, G4double dimX, G4double dimY, G4double dimZ);
+    // volumes of every grid built or registered by this object and the objects sharing its registry
+    std::shared_ptr<sisfeVolumeRegistry> m_registry = std::make_shared<sisfeVolumeRegistry>();
+    G4bool m_sharePillars = true;
+    G4LogicalVolume *m_mother = nullptr;
     G4Material *m_Vacuum = nullptr;
     G4Material *m_Si = nullptr;
     G4Material *m_LiqHe = nullptr;
@@ -89,6 +216,25 @@ private:
     G4VPhysicalVolume *m_physContainer = nullptr;
     G4VPhysicalVolume *m_physLiqHe = nullptr;
     G4VPhysicalVolume *m_physSi = nullptr;
+    // gap between two Si pillars, used by the parameterised placement
+    G4Box *m_solidGap = nullptr;
+    G4LogicalVolume *m_logicGap = nullptr;
+    G4VPhysicalVolume *m_physGap = nullptr;
+    sisfePillarParameterisation *m_gapParam = nullptr;
+    // row of (Si + LiqHe) unit cells, used by the replica placement
+    G4Box *m_solidCells = nullptr;
+    G4LogicalVolume *m_logicCells = nullptr;
+    G4VPhysicalVolume *m_physCells = nullptr;
+    G4Box *m_solidCell = nullptr;
+    G4LogicalVolume *m_logicCell = nullptr;
+    G4VPhysicalVolume *m_physCell = nullptr;
+    // layers and rows of a pillar lattice, the lattice cell is m_solidCell/m_logicCell
+    G4Box *m_solidLayer = nullptr;
+    G4LogicalVolume *m_logicLayer = nullptr;
+    G4VPhysicalVolume *m_physLayer = nullptr;
+    G4Box *m_solidRow = nullptr;
+    G4LogicalVolume *m_logicRow = nullptr;
+    G4VPhysicalVolume *m_physRow = nullptr;
     // names
     G4String m_nameID = "";
     G4String m_nameSolidContainer = "";
@@ -100,8 +246,40 @@ private:
     G4String m_nameSolidSi = "";
     G4String m_nameLogicSi = "";
     G4String m_namePhysSi = "";
+    G4String m_nameSolidGap = "";
+    G4String m_nameLogicGap = "";
+    G4String m_namePhysGap = "";
+    G4String m_nameSolidCells = "";
+    G4String m_nameLogicCells = "";
+    G4String m_namePhysCells = "";
+    G4String m_nameSolidCell = "";
+    G4String m_nameLogicCell = "";
+    G4String m_namePhysCell = "";
+    G4String m_nameSolidLayer = "";
+    G4String m_nameLogicLayer = "";
+    G4String m_namePhysLayer = "";
+    G4String m_nameSolidRow = "";
+    G4String m_nameLogicRow = "";
+    G4String m_namePhysRow = "";
+    // placement mode of the pillars: "place" (one volume and placement per pillar), "param" or "replica" (shared volumes),
+    // "lattice" (2D/3D array of Si posts in a fill material)
+    G4String m_placement = "place";
+    // overlap check at every placement, switched off when the overlaps are validated after construction
+    G4bool m_checkOverlaps = true;
     G4int m_nLiqHe = 0; // number of LiqHe pillars
     G4int m_nSi = 0;    // number of Si pillars
+    // lattice of Si posts: cells along X and Y, layers along Z, "square" or "hex" cell
+    G4int m_latticeNX = 0;
+    G4int m_latticeNY = 0;
+    G4int m_latticeNLayers = 1;
+    G4double m_pitchX = 0.;
+    G4double m_pitchY = 0.;
+    G4String m_latticeCell = "square";
+    G4Material *m_Fill = nullptr; // material around the posts, LiqHe if not set
+    // owner of the parameterisations, released with the geometry
+    GeometryArena *m_arena = nullptr;
+    // region the container is the root of, none if not set
+    G4Region *m_region = nullptr;
     // dimensions of LiqHe pillars
     G4double m_LiqHeDimX = 0.;
     G4double m_LiqHeDimY = 0.;
@@ -119,9 +297,10 @@ private:
     //rotation
     G4RotationMatrix *m_rot;
     // colour
-    G4VisAttributes* m_colorContainer;
-    G4VisAttributes* m_colorLiqHe;
-    G4VisAttributes* m_colorSi;
+    // colours, shared attributes of the VisPalette
+    const G4VisAttributes* m_colorContainer = VisPalette::Instance().Get("white");
+    const G4VisAttributes* m_colorLiqHe = VisPalette::Instance().Get("white");
+    const G4VisAttributes* m_colorSi = VisPalette::Instance().Get("white");
 };
 }
 #endif
\ No newline at end of file
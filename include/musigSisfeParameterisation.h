@@ -0,0 +1,25 @@
+#ifndef SISFE_PARAMETERISATION_H
+#define SISFE_PARAMETERISATION_H
+
+#include <G4VPVParameterisation.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4ThreeVector.hh>
+
+namespace MuSiG {
+
+// places copy i of a pillar at (start + i * pitch, offsetY, 0) inside its mother
+class sisfePillarParameterisation : public G4VPVParameterisation
+{
+public:
+    sisfePillarParameterisation(G4double start, G4double pitch, G4double offsetY);
+    ~sisfePillarParameterisation() override;
+
+    void ComputeTransformation(const G4int copyNo, G4VPhysicalVolume *physVol) const override;
+
+private:
+    G4double m_start = 0.;
+    G4double m_pitch = 0.;
+    G4double m_offsetY = 0.;
+};
+}
+#endif
@@ -0,0 +1,88 @@
+#ifndef MUSIG_STOPPINGSCORER_H
+#define MUSIG_STOPPINGSCORER_H
+
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <globals.hh>
+#include <G4StepStatus.hh>
+#include <G4ThreeVector.hh>
+#include <G4TrackStatus.hh>
+#include <G4VSensitiveDetector.hh>
+
+#include "musigSisfe.h"
+
+
+namespace MuSiG {
+
+
+    typedef struct StoppingHistogramDefinition {
+        G4String container;        // logical volume whose frame and box the histogram covers, empty for none
+        G4int nX = 0;
+        G4int nY = 0;
+        G4int nZ = 0;
+    } StoppingHistogramDefinition;
+
+
+    typedef struct StoppingCounts {
+        std::map<std::pair<std::string, G4int>, G4long> volumes;  // (logical volume, copy number or sisfe column) -> stops
+        std::vector<G4long> histogram;                            // nX * nY * nZ bins, X fastest
+        G4int nX = 0;
+        G4int nY = 0;
+        G4int nZ = 0;
+        G4ThreeVector halfSize;                                   // half lengths of the container box
+        G4long total = 0;
+    } StoppingCounts;
+
+
+    /// Sensitive detector counting where the muons (mu+, mu-, Mu) stop: per logical volume and copy number,
+    /// and in a 3D histogram in the local frame of a container box (e.g. a sisfe grid). Every thread has its
+    /// own scorer and counts; Merge() sums the counts of all the threads, e.g. at the end of a run.
+    class StoppingScorer : public G4VSensitiveDetector {
+    public:
+
+        StoppingScorer(const G4String &name, const StoppingHistogramDefinition &histogram);
+
+        ~StoppingScorer() override;
+
+        G4bool ProcessHits(G4Step *step, G4TouchableHistory *) override;
+
+        /// true for the step where a muon comes to rest, once per muon: not for the at-rest step of its decay or
+        /// capture, nor for a decay in flight
+        static G4bool IsStop(G4TrackStatus trackStatus, G4StepStatus stepStatus, G4double kineticEnergy);
+
+        /// stops in the pillars of the grids of the registry are counted per column instead of copy number, under the
+        /// pillar volume name of their grid
+        void SetPillarIdentification(std::shared_ptr<const sisfeVolumeRegistry> registry) {
+            fPillars = std::move(registry);
+        }
+
+        /// counts of all the threads
+        static StoppingCounts Merge();
+
+        static void Reset();
+
+        /// counts per volume and the projections of the histogram on X, Y and Z
+        static void Print();
+
+        /// counts per volume and the filled bins of the histogram as CSV
+        static void Write(const G4String &fileName);
+
+    private:
+        static std::vector<StoppingScorer *> &Scorers();
+
+        StoppingHistogramDefinition fHistogram;
+        StoppingCounts fCounts;
+
+        std::shared_ptr<const sisfeVolumeRegistry> fPillars;
+    };
+
+
+}
+
+
+#endif
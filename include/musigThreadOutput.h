@@ -0,0 +1,78 @@
+#ifndef MUSIG_THREADOUTPUT_H
+#define MUSIG_THREADOUTPUT_H
+
+
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <globals.hh>
+
+
+namespace MuSiG {
+
+
+    /// Buffered per-thread output of the run. Every thread writes the records of its events (hits of
+    /// muonium/TrackerDetectorSD, run summaries, ...) into its own part file, in chunks tagged with the event ID,
+    /// so the threads never share a stream. At the end of the run the master merges the part files by event ID
+    /// into the single output file, with the same content and order as a sequential run.
+    ///
+    /// Worker side (RunAction, EventAction, sensitive detector of the thread):
+    ///     ThreadOutput::Instance()->BeginRun(fileName);             // BeginOfRunAction
+    ///     ThreadOutput::Instance()->BeginEvent(event->GetEventID());  // BeginOfEventAction
+    ///     ThreadOutput::Instance()->Stream() << ...;                  // hits, as into the output file
+    ///     ThreadOutput::Instance()->EndEvent();                       // EndOfEventAction
+    ///     ThreadOutput::Instance()->EndRun();                         // EndOfRunAction
+    /// Master side, EndOfRunAction (also in sequential mode, where the master thread is the only writer):
+    ///     ThreadOutput::Merge(fileName, header);
+    class ThreadOutput {
+    public:
+
+        /// output of the calling thread
+        static ThreadOutput *Instance();
+
+        ThreadOutput(const ThreadOutput &) = delete;
+
+        ThreadOutput &operator=(const ThreadOutput &) = delete;
+
+        void BeginRun(const G4String &fileName);
+
+        void BeginEvent(G4int eventID);
+
+        std::ostream &Stream() { return fEvent; }
+
+        void EndEvent();
+
+        void EndRun();
+
+        /// bytes of events kept in memory before they are written to the part file
+        void SetChunkSize(std::size_t bytes) { fChunkSize = bytes; }
+
+        /// merges the part files of the run named fileName into fileName and removes them, the header is
+        /// written first; returns the number of events merged
+        static G4long Merge(const G4String &fileName, const G4String &header = "");
+
+        static G4String PartName(const G4String &fileName, G4int threadID);
+
+    private:
+        ThreadOutput() = default;
+
+        void Flush();
+
+        G4String fPartName;
+        std::ofstream fPart;
+
+        std::ostringstream fEvent;
+        G4int fEventID = -1;
+
+        std::vector<char> fChunk;
+        std::size_t fChunkSize = 4 * 1024 * 1024;
+    };
+
+
+}
+
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef MUSIG_VISPALETTE_H
+#define MUSIG_VISPALETTE_H
+
+
+#include <map>
+#include <memory>
+#include <tuple>
+
+#include <globals.hh>
+#include <G4Colour.hh>
+#include <G4Threading.hh>
+#include <G4VisAttributes.hh>
+
+
+namespace MuSiG {
+
+
+    /// Process-wide palette of vis attributes shared by DetectorConstruction and sisfeGeometry. Attributes are
+    /// interned by RGBA (and visibility): the same colour always gives the same G4VisAttributes, so rebuilding the
+    /// geometry allocates none. The attributes live as long as the process.
+    ///
+    /// A colour is a name (red, green, blue, yellow, magenta, white, invisible, in any case) or r,g,b[,a] with
+    /// components between 0 and 1, e.g. 0.2,0.6,1 or 0.2,0.6,1,0.3.
+    class VisPalette {
+    public:
+
+        static VisPalette &Instance();
+
+        /// attributes of a colour name or r,g,b[,a], nullptr if the colour is not valid
+        const G4VisAttributes *Get(const G4String &colour);
+
+        const G4VisAttributes *Get(const G4Colour &colour, G4bool visible = true);
+
+        /// number of distinct attributes made so far
+        std::size_t Size() const;
+
+    private:
+        VisPalette() = default;
+
+        static G4bool Parse(const G4String &colour, G4Colour &result, G4bool &visible);
+
+        // (r, g, b, a, visible) -> attributes
+        std::map<std::tuple<G4double, G4double, G4double, G4double, G4bool>, std::unique_ptr<G4VisAttributes>> fAttributes;
+        mutable G4Mutex fMutex;
+    };
+
+
+}
+
+
+#endif
@@ -1,6 +1,10 @@
 #include "musigDetectorConstruction.h"
 #include "musigDetectorMessenger.h"
 #include "musigTrackerSD.h"
+#include "musigOverlapValidator.h"
+#include "musigGeometryCache.h"
+#include "musigShapeTable.h"
+#include "musigVisPalette.h"
 
 #include <G4PhysicalConstants.hh>
 #include <G4Material.hh>
@@ -8,9 +12,19 @@
 #include <G4Tubs.hh>
 #include <G4LogicalVolume.hh>
 #include <G4LogicalVolumeStore.hh>
+#include <G4PhysicalVolumeStore.hh>
+#include <G4SolidStore.hh>
+#include <G4GeometryManager.hh>
+#include <G4SmartVoxelHeader.hh>
+#include <G4Threading.hh>
+#include <voxeldefs.hh>
+#include <G4Region.hh>
+#include <G4RegionStore.hh>
+#include <G4ProductionCuts.hh>
 #include <G4PVPlacement.hh>
 #include <G4PVReplica.hh>
 #include <G4SDManager.hh>
+#include <G4MultiSensitiveDetector.hh>
 #include <G4RunManager.hh>
 #include <G4RotationMatrix.hh>
 #include <G4GeometryTolerance.hh>
@@ -25,8 +39,11 @@
 #include <G4SystemOfUnits.hh>
 #include <G4ios.hh>
 
+#include <algorithm>
 #include <vector>
 #include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 
 
 ///---- constructor with initializer list ------------------------
@@ -34,7 +51,6 @@
 namespace MuSiG {
 
     DetectorConstruction::DetectorConstruction() : fWorldLength(0., 0., 0.) {
-        sisfe = sisfeGeometry();
         DefineMaterials();
 
         detectorMessenger = new DetectorMessenger(this);
@@ -44,6 +60,11 @@ namespace MuSiG {
 
     DetectorConstruction::~DetectorConstruction() {
         delete stepLimit;
+        delete smallstepLimit;
+        for (auto &regionDef: fRegions) {
+            delete regionDef.limits;
+            delete regionDef.cuts;
+        }
         delete physiWorld;
         delete detectorMessenger;
     }
@@ -51,196 +72,501 @@ namespace MuSiG {
 
     void DetectorConstruction::DefineMaterials() {
 
-        G4NistManager *manager = G4NistManager::Instance();
-        manager->SetVerbose(0);
-
-        auto H = manager->FindOrBuildElement(1);
-        auto C = manager->FindOrBuildElement(6);
-        auto N = manager->FindOrBuildElement(7);
-        auto O = manager->FindOrBuildElement(8);
-        auto Si = manager->FindOrBuildElement(14);
-        auto Ge = manager->FindOrBuildElement(32);
-        auto Sb = manager->FindOrBuildElement(51);
-        auto I = manager->FindOrBuildElement(53);
-        auto Cs = manager->FindOrBuildElement(55);
-        auto Pb = manager->FindOrBuildElement(82);
-        auto Bi = manager->FindOrBuildElement(83);
-        auto Ca = new G4Element("Ca", "Ca", 31, (69.72 * g / mole));
-        auto Na = new G4Element("Na", "Na", 11, (22.99 * g / mole));
-        auto Mg = new G4Element("Mg", "Mg", 12, (24.305 * g / mole));
-        auto K = new G4Element("K", "K", 19, (39.1 * g / mole));
-        auto Mn = new G4Element("Mn", "Mn", 25, (54.93 * g / mole));
-        auto Zn = new G4Element("Zn", "Zn", 30, (65.38 * g / mole));
-        auto Ti = new G4Element("Ti", "Ti", 22, (47.86 * g / mole));
-        auto Cr = new G4Element("Cr", "Cr", 24, (51.99 * g / mole));
-        auto Al = new G4Element("Al", "Al", 13, (26.98 * g / mole));
-        auto Cu = new G4Element("Cu", "Cu", 29, (63.55 * g / mole));
-        auto Fe = new G4Element("Fe", "Fe", 26, (55.845 * g / mole));
-
-        auto Paraffin = manager->FindOrBuildMaterial("G4_PARAFFIN");
-        auto Graphite = manager->FindOrBuildMaterial("G4_GRAPHITE");
-        auto Kapton = manager->FindOrBuildMaterial("G4_KAPTON");
-        Mylar = manager->FindOrBuildMaterial("G4_MYLAR");
+        G4NistManager::Instance()->SetVerbose(0);
+
+        // the materials are only registered here and built by fMaterials the first time a definition uses them,
+        // names not registered are taken from the NIST database (G4_...)
+        auto &reg = fMaterials;
+
+        auto element = [&reg](const G4String &name, const G4String &symbol, G4double z, G4double a) {
+            reg.RegisterElement(name, [name, symbol, z, a]() { return new G4Element(name, symbol, z, a); });
+        };
+        element("Ca", "Ca", 31, (69.72 * g / mole));
+        element("Na", "Na", 11, (22.99 * g / mole));
+        element("Mg", "Mg", 12, (24.305 * g / mole));
+        element("K", "K", 19, (39.1 * g / mole));
+        element("Mn", "Mn", 25, (54.93 * g / mole));
+        element("Zn", "Zn", 30, (65.38 * g / mole));
+        element("Ti", "Ti", 22, (47.86 * g / mole));
+        element("Cr", "Cr", 24, (51.99 * g / mole));
+        element("Al", "Al", 13, (26.98 * g / mole));
+        element("Cu", "Cu", 29, (63.55 * g / mole));
+        element("Fe", "Fe", 26, (55.845 * g / mole));
 
         // define an Element from isotopes, by relative abundance
-
-        auto U5 = new G4Isotope("U235", 92, 235, (235.01 * g / mole));
-        auto U8 = new G4Isotope("U238", 92, 238, (238.03 * g / mole));
-        auto U = new G4Element("enriched Uranium", "U", 2);
-        U->AddIsotope(U5, (90. * perCent));
-        U->AddIsotope(U8, (10. * perCent));
+        reg.RegisterElement("enriched Uranium", []() {
+            auto U5 = new G4Isotope("U235", 92, 235, (235.01 * g / mole));
+            auto U8 = new G4Isotope("U238", 92, 238, (238.03 * g / mole));
+            auto U = new G4Element("enriched Uranium", "U", 2);
+            U->AddIsotope(U5, (90. * perCent));
+            U->AddIsotope(U8, (10. * perCent));
+            return U;
+        });
 
         // define simple materials
 
-        auto liquidH2 = new G4Material("liquidH2", 1, (1.008 * g / mole), (70.8 * mg / cm3));
-        auto tungsten = new G4Material("Tungsten", 74, (183.85 * g / mole), (19.30 * g / cm3));
-        auto gold = new G4Material("Gold", 79, (196.97 * g / mole), (19.32 * g / cm3));
-        auto uranium = new G4Material("Uranium", 92, (238.03 * g / mole), (18.95 * g / cm3));
-        auto iron = new G4Material("Iron", 26, (55.85 * g / mole), (7.870 * g / cm3));
+        auto simple = [&reg](const G4String &name, G4double z, G4double a, G4double density) {
+            reg.Register(name, [name, z, a, density]() { return new G4Material(name, z, a, density); });
+        };
+        simple("liquidH2", 1, (1.008 * g / mole), (70.8 * mg / cm3));
+        simple("Tungsten", 74, (183.85 * g / mole), (19.30 * g / cm3));
+        simple("Gold", 79, (196.97 * g / mole), (19.32 * g / cm3));
+        simple("Uranium", 92, (238.03 * g / mole), (18.95 * g / cm3));
+        simple("Iron", 26, (55.85 * g / mole), (7.870 * g / cm3));
 
-        Aluminium = new G4Material("Aluminium", 13, (26.982 * g / mole), (2.699 * g / cm3));
-        Titanium = new G4Material("Titanium", 22, (47.867 * g / mole), (4.54 * g / cm3));
-        Copper = new G4Material("Copper", 29, (63.55 * g / mole), (8.960 * g / cm3));
-        Berillium = new G4Material("Berillium", 4, (9.1 * g / mole), (1.85 * g / cm3));
-        Lithium = new G4Material("Lithium", 3, (6.941 * g / mole), (0.525 * g / cm3));
+        simple("Aluminium", 13, (26.982 * g / mole), (2.699 * g / cm3));
+        simple("Titanium", 22, (47.867 * g / mole), (4.54 * g / cm3));
+        simple("Copper", 29, (63.55 * g / mole), (8.960 * g / cm3));
+        simple("Berillium", 4, (9.1 * g / mole), (1.85 * g / cm3));
+        simple("Lithium", 3, (6.941 * g / mole), (0.525 * g / cm3));
 
-        Ar_gas = new G4Material("Ar_gas", 18, (39.948 * g / mole),
-                                (0.00178 * g / cm3)); // in NIST, 0.00166*g/cm3, in Wiki 0.00178*g/cm3
-        Ar_gas->GetIonisation()->SetMeanExcitationEnergy(188.0 * eV);
+        reg.Register("Ar_gas", []() {
+            auto Ar_gas = new G4Material("Ar_gas", 18, (39.948 * g / mole),
+                                         (0.00178 * g / cm3)); // in NIST, 0.00166*g/cm3, in Wiki 0.00178*g/cm3
+            Ar_gas->GetIonisation()->SetMeanExcitationEnergy(188.0 * eV);
+            return Ar_gas;
+        });
 
-        CNTforest = new G4Material("CNTforest", 6, (12.0107 * g / mole), (0.1 * g / cm3));
+        simple("CNTforest", 6, (12.0107 * g / mole), (0.1 * g / cm3));
 
 
         //liquid helium (0.12496*g/cm3) or gaseous helium (0.012 g/cm3) at atmospheric pressure
         //5.8 K 3.44e21 1/cm3    --- 0.023 g/cm3 at 2 bar, 0.0154 at 1.5 bar, 0.00946 at 1 bar
         // 6  K 1.5 bar / 0.0146 g/cm3, 1.6 bar / 0.0158 g/cm3, 1.7 bar 0.0171 g/cm3
 
-        LiqHe = new G4Material("LiqHe", 2, (4.0 * g / mole), (0.145 * g / cm3));  // 0.12...volt
-        GasHe = new G4Material("GasHe", 2, (4.0 * g / mole), (0.00000171 * g / cm3));  // 0.023
+        simple("LiqHe", 2, (4.0 * g / mole), (0.145 * g / cm3));  // 0.12...volt
+        simple("GasHe", 2, (4.0 * g / mole), (0.00000171 * g / cm3));  // 0.023
 
 
         // define a material from elements.   case 1: chemical molecule
 
-        Water = new G4Material("Water", (1. * g / cm3), 2);
-        Water->AddElement(H, 2);
-        Water->AddElement(O, 1);
-        Water->GetIonisation()->SetMeanExcitationEnergy(78.0 * eV);
-        Water->SetChemicalFormula("H_2O");
+        reg.Register("Water", [&reg]() {
+            auto Water = new G4Material("Water", (1. * g / cm3), 2);
+            Water->AddElement(reg.GetElement("H"), 2);
+            Water->AddElement(reg.GetElement("O"), 1);
+            Water->GetIonisation()->SetMeanExcitationEnergy(78.0 * eV);
+            Water->SetChemicalFormula("H_2O");
+            return Water;
+        });
+
+        reg.Register("Scintillator", [&reg]() {
+            auto Scintillator = new G4Material("Scintillator", (1.032 * g / cm3), 2);
+            Scintillator->AddElement(reg.GetElement("H"), (8.5 * perCent));  // 14
+            Scintillator->AddElement(reg.GetElement("C"), (91.5 * perCent));  // 86
+            Scintillator->GetIonisation()->SetMeanExcitationEnergy(64.7 * eV);
+            Scintillator->GetIonisation()->SetBirksConstant(0.126 * mm / MeV);
+            return Scintillator;
+        });
+
+        reg.Register("Lucite", [&reg]() {
+            auto Lucite = new G4Material("Lucite", (1.185 * g / cm3), 3);
+            Lucite->AddElement(reg.GetElement("C"), 59.97 * perCent);
+            Lucite->AddElement(reg.GetElement("H"), 8.07 * perCent);
+            Lucite->AddElement(reg.GetElement("O"), 31.96 * perCent);
+            return Lucite;
+        });
+
+        reg.Register("Silicon", [&reg]() {
+            auto Silicon = new G4Material("Silicon", (2.330 * g / cm3), 1);
+            Silicon->AddElement(reg.GetElement("Si"), 1);
+            return Silicon;
+        });
+
+        reg.Register("FusedSilica", [&reg]() {
+            auto FusedSilica = new G4Material("FusedSilica", (2.200 * g / cm3), 2);
+            FusedSilica->AddElement(reg.GetElement("Si"), 1);
+            FusedSilica->AddElement(reg.GetElement("O"), 2);
+            return FusedSilica;
+        });
+
+        reg.Register("CsI", [&reg]() {
+            auto CsI = new G4Material("CsI", (4.534 * g / cm3), 2);
+            CsI->AddElement(reg.GetElement("Cs"), 1);
+            CsI->AddElement(reg.GetElement("I"), 1);
+            CsI->GetIonisation()->SetMeanExcitationEnergy(553.1 * eV);
+            return CsI;
+        });
+
+        reg.Register("BGO", [&reg]() {
+            auto BGO = new G4Material("BGO", (7.10 * g / cm3), 3);
+            BGO->AddElement(reg.GetElement("O"), 12);
+            BGO->AddElement(reg.GetElement("Ge"), 3);
+            BGO->AddElement(reg.GetElement("Bi"), 4);
+            return BGO;
+        });
 
-        Scintillator = new G4Material("Scintillator", (1.032 * g / cm3), 2);
-        Scintillator->AddElement(H, (8.5 * perCent));  // 14
-        Scintillator->AddElement(C, (91.5 * perCent));  // 86
-        Scintillator->GetIonisation()->SetMeanExcitationEnergy(64.7 * eV);
-        Scintillator->GetIonisation()->SetBirksConstant(0.126 * mm / MeV);
+        // Concrete
+        //G4Material* Sil = new G4Material("Sil", 14, 28.09*g/mole, 2.33*g/cm3);
+        reg.Register("Concrete", [&reg]() {
+            auto Concrete = new G4Material("Concrete", (2.31 * g / cm3), 9);
+            Concrete->AddElement(reg.GetElement("H"), 1.1 * perCent);
+            Concrete->AddElement(reg.GetElement("O"), 48.2 * perCent);
+            Concrete->AddElement(reg.GetElement("Na"), 2.0 * perCent);
+            Concrete->AddElement(reg.GetElement("Mg"), 1.1 * perCent);
+            Concrete->AddElement(reg.GetElement("Al"), 6.1 * perCent);
+            Concrete->AddElement(reg.GetElement("Si"), 22.4 * perCent);
+            Concrete->AddElement(reg.GetElement("K"), 1.0 * perCent);
+            Concrete->AddElement(reg.GetElement("Ca"), 12.4 * perCent);
+            Concrete->AddElement(reg.GetElement("Fe"), 5.7 * perCent);
+            return Concrete;
+        });
 
-        Lucite = new G4Material("Lucite", (1.185 * g / cm3), 3);
-        Lucite->AddElement(C, 59.97 * perCent);
-        Lucite->AddElement(H, 8.07 * perCent);
-        Lucite->AddElement(O, 31.96 * perCent);
+        // define gaseous materials using G4 NIST database
+        reg.Register("Air20", []() {
+            return G4NistManager::Instance()->ConstructNewGasMaterial("Air20", "G4_AIR", (293. * kelvin),
+                                                                      (1. * atmosphere));
+        });
 
-        Silicon = new G4Material("Silicon", (2.330 * g / cm3), 1);
-        Silicon->AddElement(Si, 1);
+        //-------- define a material from elements and others materials (mixture of mixtures)
+        reg.Register("Lead", [&reg]() {
+            auto Lead = new G4Material("Lead", (11.35 * g / cm3), 1);
+            Lead->AddElement(reg.GetElement("Pb"), 1.0);
+            return Lead;
+        });
+
+        reg.Register("LeadSb", [&reg]() {
+            auto LeadSb = new G4Material("LeadSb", (11.35 * g / cm3), 2);
+            LeadSb->AddElement(reg.GetElement("Sb"), (4. * perCent));
+            LeadSb->AddElement(reg.GetElement("Pb"), (96. * perCent));
+            return LeadSb;
+        });
+
+        reg.Register("Aerogel", [&reg]() {
+            auto Aerogel = new G4Material("Aerogel", (0.029 * g / cm3), 3);
+            Aerogel->AddMaterial(reg.Get("FusedSilica"), (62.5 * perCent));
+            Aerogel->AddMaterial(reg.Get("Water"), (37.4 * perCent));
+            Aerogel->AddElement(reg.GetElement("C"), (0.1 * perCent));
+            return Aerogel;
+        });
 
-        FusedSilica = new G4Material("FusedSilica", (2.200 * g / cm3), 2);
-        FusedSilica->AddElement(Si, 1);
-        FusedSilica->AddElement(O, 2);
+        //------------- examples of gas in non STP conditions
 
-        CsI = new G4Material("CsI", (4.534 * g / cm3), 2);
-        CsI->AddElement(Cs, 1);
-        CsI->AddElement(I, 1);
-        CsI->GetIonisation()->SetMeanExcitationEnergy(553.1 * eV);
+        reg.Register("CarbonicGas", [&reg]() {
+            auto CO2 = new G4Material("CarbonicGas", (27. * mg / cm3), 2, kStateGas, (325. * kelvin),
+                                      (50. * atmosphere));
+            CO2->AddElement(reg.GetElement("C"), 1);
+            CO2->AddElement(reg.GetElement("O"), 2);
+            return CO2;
+        });
+
+        reg.Register("WaterSteam", [&reg]() {
+            auto steam = new G4Material("WaterSteam", (1.0 * mg / cm3), 1, kStateGas, (273 * kelvin),
+                                        (1 * atmosphere));
+            steam->AddMaterial(reg.Get("Water"), 1.);
+            return steam;
+        });
+
+        reg.Register("ArgonGas", []() {
+            return new G4Material("ArgonGas", 18, (39.948 * g / mole), (1.782 * mg / cm3), kStateGas,
+                                  273.15 * kelvin, 1 * atmosphere);
+        });
 
-        BGO = new G4Material("BGO", (7.10 * g / cm3), 3);
-        BGO->AddElement(O, 12);
-        BGO->AddElement(Ge, 3);
-        BGO->AddElement(Bi, 4);
+        // ------------- examples of vacuum
 
-        // Concrete
-        //G4Material* Sil = new G4Material("Sil", 14, 28.09*g/mole, 2.33*g/cm3);
-        Concrete = new G4Material("Concrete", (2.31 * g / cm3), 9);
-        Concrete->AddElement(H, 1.1 * perCent);
-        Concrete->AddElement(O, 48.2 * perCent);
-        Concrete->AddElement(Na, 2.0 * perCent);
-        Concrete->AddElement(Mg, 1.1 * perCent);
-        Concrete->AddElement(Al, 6.1 * perCent);
-        Concrete->AddElement(Si, 22.4 * perCent);
-        Concrete->AddElement(K, 1.0 * perCent);
-        Concrete->AddElement(Ca, 12.4 * perCent);
-        Concrete->AddElement(Fe, 5.7 * perCent);
+        reg.Register("Galactic", []() {
+            return new G4Material("Galactic", 1., 1.008 * g / mole, universe_mean_density, kStateGas,
+                                  (2.73 * kelvin), (3e-18 * pascal));
+        });
 
-        // define gaseous materials using G4 NIST database
-        auto Air = manager->FindOrBuildMaterial("G4_AIR");
-        manager->ConstructNewGasMaterial("Air20", "G4_AIR", (293. * kelvin), (1. * atmosphere));
+        reg.Register("Beam", [&reg]() {
+            auto Beamvacuum = new G4Material("Beam", (1e-5 * g / cm3), 1, kStateGas, STP_Temperature, (2e-2 * bar));
+            Beamvacuum->AddMaterial(reg.Get("G4_AIR"), 1.);
+            return Beamvacuum;
+        });
 
-        //-------- define a material from elements and others materials (mixture of mixtures)
-        auto Lead = new G4Material("Lead", (11.35 * g / cm3), 1);
-        Lead->AddElement(Pb, 1.0);
 
-        auto LeadSb = new G4Material("LeadSb", (11.35 * g / cm3), 2);
-        LeadSb->AddElement(Sb, (4. * perCent));
-        LeadSb->AddElement(Pb, (96. * perCent));
+        reg.Register("Vacuum", []() {
+            return new G4Material("Vacuum", 1., (1.01 * g / mole), (1.e-5 * g / cm3), kStateGas, (293 * kelvin),
+                                  (2.e-10 * bar));
+        });
 
-        Aerogel = new G4Material("Aerogel", (0.029 * g / cm3), 3);
-        Aerogel->AddMaterial(FusedSilica, (62.5 * perCent));
-        Aerogel->AddMaterial(Water, (37.4 * perCent));
-        Aerogel->AddElement(C, (0.1 * perCent));
+        // General plastic (BC408 scintillator density, used in my simulations)
+        reg.Register("Plastic", [&reg]() {
+            auto Plastic = new G4Material("Plastic", (1.06 * g / cm3), 2);   // 1.032 - BC408
+            Plastic->AddElement(reg.GetElement("H"), 7.74 * perCent);  // 14
+            Plastic->AddElement(reg.GetElement("C"), 92.26 * perCent);  // 86
+            return Plastic;
+        });
 
-        //------------- examples of gas in non STP conditions
 
-        auto CO2 = new G4Material("CarbonicGas", (27. * mg / cm3), 2, kStateGas, (325. * kelvin), (50. * atmosphere));
-        CO2->AddElement(C, 1);
-        CO2->AddElement(O, 2);
+        // Antico from CERN workshop
+        reg.Register("Antico", [&reg]() {
+            auto Antico = new G4Material("Antico", (2.7 * g / cm3), 9);
+            Antico->AddElement(reg.GetElement("Al"), 96.25 * perCent);
+            Antico->AddElement(reg.GetElement("Cu"), 0.1 * perCent);
+            Antico->AddElement(reg.GetElement("Si"), 1. * perCent);
+            Antico->AddElement(reg.GetElement("Mn"), 0.7 * perCent);
+            Antico->AddElement(reg.GetElement("Mg"), 0.9 * perCent);
+            Antico->AddElement(reg.GetElement("Zn"), 0.2 * perCent);
+            Antico->AddElement(reg.GetElement("Fe"), 0.5 * perCent);
+            Antico->AddElement(reg.GetElement("Ti"), 0.1 * perCent);
+            Antico->AddElement(reg.GetElement("Cr"), 0.25 * perCent);
+            return Antico;
+        });
 
-        auto steam = new G4Material("WaterSteam", (1.0 * mg / cm3), 1, kStateGas, (273 * kelvin), (1 * atmosphere));
-        steam->AddMaterial(Water, 1.);
+    }
 
-        auto argonGas = new G4Material("ArgonGas", 18, (39.948 * g / mole), (1.782 * mg / cm3), kStateGas,
-                                       273.15 * kelvin, 1 * atmosphere);
 
-        // ------------- examples of vacuum
+    G4VPhysicalVolume *DetectorConstruction::Construct() {
 
-        Galactic = new G4Material("Galactic", 1., 1.008 * g / mole, universe_mean_density, kStateGas, (2.73 * kelvin), (3e-18 * pascal));
+        fProfiler.Reset();
 
-        Beamvacuum = new G4Material("Beam", (1e-5 * g / cm3), 1, kStateGas, STP_Temperature, (2e-2 * bar));
-        Beamvacuum->AddMaterial(Air, 1.);
+        ReleaseGeometry();
 
+///---------------------------------------------------------------------------
+///         Geometry cache
+///---------------------------------------------------------------------------
 
-        Vacuum = new G4Material("Vacuum", 1., (1.01 * g / mole), (1.e-5 * g / cm3), kStateGas, (293 * kelvin),
-                                (2.e-10 * bar));
+        G4String cacheFile;
+        G4bool fromCache = false;
 
-        // General plastic (BC408 scintillator density, used in my simulations)
-        Plastic = new G4Material("Plastic", (1.06 * g / cm3), 2);   // 1.032 - BC408
-        Plastic->AddElement(H, 7.74 * perCent);  // 14
-        Plastic->AddElement(C, 92.26 * perCent);  // 86
+        if (!fCacheDirectory.empty() && GeometryCache::IsAvailable()) {
+            cacheFile = GeometryCache::FileName(fCacheDirectory, fSetupDigest.Hex());
+            if (GeometryCache::Exists(cacheFile)) {
+                fProfiler.BeginPhase("cache load");
+                physiWorld = GeometryCache::Load(cacheFile);
+                fromCache = (physiWorld != nullptr);
+            }
+        }
 
+        if (fromCache) {
+            logicWorld = physiWorld->GetLogicalVolume();
+            solidWorld = dynamic_cast<G4Box *>(logicWorld->GetSolid());
+            RegisterTree(logicWorld);
+
+            // vis attributes are not stored in GDML
+            for (const auto &fSisfeParams: fSisfeParamsV) {
+                if (fSisfeParams.isPlaced) {
+                    auto &grid = SisfeGrid(fSisfeParams);
+                    grid.ApplyColours();
+                    grid.ApplyRegion();
+                    grid.RegisterVolumes(FindVolume(grid.GetNameLogicContainer()));
+                }
+            }
+        } else {
+            ConstructVolumes();
+            fMaterials.PrintBuilt();
+        }
 
-        // Antico from CERN workshop
-        Antico = new G4Material("Antico", (2.7 * g / cm3), 9);
-        Antico->AddElement(Al, 96.25 * perCent);
-        Antico->AddElement(Cu, 0.1 * perCent);
-        Antico->AddElement(Si, 1. * perCent);
-        Antico->AddElement(Mn, 0.7 * perCent);
-        Antico->AddElement(Mg, 0.9 * perCent);
-        Antico->AddElement(Zn, 0.2 * perCent);
-        Antico->AddElement(Fe, 0.5 * perCent);
-        Antico->AddElement(Ti, 0.1 * perCent);
-        Antico->AddElement(Cr, 0.25 * perCent);
+        ConstructAttributes();
 
-        SiM = manager->FindOrBuildMaterial("G4_Si");
-        sisfe.DefineMaterials(Galactic, LiqHe, SiM);
-        // Print all the materials defined.
-        G4cout << G4endl << "The materials defined are : " << G4endl << G4endl;
-        G4cout << *(G4Material::GetMaterialTable()) << G4endl;
+//--------------------------------------Geometry cache ----------------------------------------
+        if (!cacheFile.empty() && !fromCache) {
+            fProfiler.BeginPhase("cache store");
+            GeometryCache::Store(cacheFile, physiWorld);
+        }
+//--------------------------------------Deferred overlap validation ----------------------------------------
+        if (fOverlapMode == "deferred") {
+            fProfiler.BeginPhase("overlaps");
+            ValidateOverlaps();
+        }
+//----------------------------------------------------------------------------
+        fProfiler.EndPhase();
+        fProfiler.PrintSummary();
 
+        fDirtyVolumes.clear();
+        fDirtySisfe.clear();
+        fFullRebuild = false;
+
+        return physiWorld;
     }
 
 
-    G4VPhysicalVolume *DetectorConstruction::Construct() {
+    void DetectorConstruction::ConstructSDandField() {
+
+///--------------------------------------------------------------------------------- 
+///                         Sensitive detectors
+///--------------------------------------------------------------------------------- 
+
+        // called on every worker (and by the sequential run manager) after the shared geometry is built, and
+        // again after a geometry update; the detector of a thread is made once and attached to the new volumes
+        auto trackerSD = fTrackerSD.Get();
+        if (!trackerSD) {
+            G4String trackerDetectorSDname = "muonium/TrackerDetectorSD";
+            trackerSD = new TrackerSD(trackerDetectorSDname);
+            G4SDManager::GetSDMpointer()->AddNewDetector(trackerSD);
+            fTrackerSD.Put(trackerSD);
+        }
+
+        // the volumes are resolved once on the master by ConstructAttributes, here they are only attached
+        for (auto logic: fDetVolumes) {
+            AttachSensitiveDetector(logic, trackerSD);
+        }
+        if (G4Threading::G4GetThreadId() <= 0) {
+            for (const auto &detName: fDetName) {
+                G4cout << ">>>>>>>>> Sensitive detector: " << detName << " is set" << G4endl;
+            }
+        }
+        for (auto logic: fDetSisfeVolumes) {
+            AttachSensitiveDetector(logic, trackerSD);
+        }
+        if (!fDetSisfe.empty() && (G4Threading::G4GetThreadId() <= 0)) {
+            for (const auto &det: fDetSisfe) {
+                G4cout << ">>>>>>>>> Sensitive detector: sisfe " << det.first << " " << det.second << " is set"
+                       << G4endl;
+            }
+        }
+
+        if (fStoppingLogicVolumes.empty()) {
+            return;
+        }
+        auto stoppingSD = fStoppingSD.Get();
+        if (!stoppingSD) {
+            stoppingSD = new StoppingScorer("muonium/StoppingScorer", fStoppingHistogram);
+            stoppingSD->SetPillarIdentification(fSisfeRegistry);
+            G4SDManager::GetSDMpointer()->AddNewDetector(stoppingSD);
+            fStoppingSD.Put(stoppingSD);
+        }
+        for (auto logic: fStoppingLogicVolumes) {
+            AttachSensitiveDetector(logic, stoppingSD);
+        }
+    }
+
+
+    void DetectorConstruction::AttachSensitiveDetector(G4LogicalVolume *logic, G4VSensitiveDetector *sd) {
+        // a volume that already has another detector gets a G4MultiSensitiveDetector, a volume kept by an update is
+        // not given the same one twice
+        auto current = logic->GetSensitiveDetector();
+        if (current == sd) {
+            return;
+        }
+        if (auto multi = dynamic_cast<G4MultiSensitiveDetector *>(current)) {
+            for (std::size_t i = 0; i < multi->GetSize(); ++i) {
+                if (multi->GetSD(G4int(i)) == sd) {
+                    return;
+                }
+            }
+        }
+        SetSensitiveDetector(logic, sd);
+    }
+
+
+    void DetectorConstruction::ConstructAttributes() {
+
+///--------------------------------------------------------------------------------- 
+///                         Sensitive detectors
+///--------------------------------------------------------------------------------- 
+
+        fProfiler.BeginPhase("sensitive detectors");
+
+        // the detectors themselves are thread-local and made in ConstructSDandField, here their logical volumes
+        // are resolved once on the master for all the threads
+        fDetVolumes.clear();
+        for (const auto &detName: fDetName) {
+            const auto volumes = VolumesNamed(detName);
+            if (volumes.empty()) {
+                G4cout << "<><><><><> ERROR: Logical volume for sensitive detector " << detName << " was not found!"
+                       << G4endl;
+                exit(1);
+            }
+            fDetVolumes.insert(fDetVolumes.end(), volumes.begin(), volumes.end());
+        }
+
+        fDetSisfeVolumes.clear();
+        for (const auto &det: fDetSisfe) {
+            const auto volumes = SisfeVolumes(det.first);
+            if (volumes.empty()) {
+                G4cout << "<><><><><> ERROR: sisfe grid " << det.first << " for sensitive detector was not placed!"
+                       << G4endl;
+                exit(1);
+            }
+            auto &grid = fSisfeGrids.at(det.first);
+            for (auto logic: volumes) {
+                const auto &name = logic->GetName();
+                if (((det.second != "Si") && (name == grid.GetNameLogicLiqHe())) ||
+                    ((det.second != "LiqHe") && (name == grid.GetNameLogicSi()))) {
+                    fDetSisfeVolumes.push_back(logic);
+                }
+            }
+        }
+
+        fStoppingLogicVolumes.clear();
+        for (const auto &name: fStoppingVolumes) {
+            const auto volumes = VolumesNamed(name);
+            if (volumes.empty()) {
+                G4cout << "<><><><><> ERROR: Logical volume for stopping scorer " << name << " was not found!"
+                       << G4endl;
+                exit(1);
+            }
+            fStoppingLogicVolumes.insert(fStoppingLogicVolumes.end(), volumes.begin(), volumes.end());
+        }
+        for (const auto &grid: fStoppingGrids) {
+            const auto volumes = SisfeVolumes(grid);
+            fStoppingLogicVolumes.insert(fStoppingLogicVolumes.end(), volumes.begin(), volumes.end());
+        }
+
+//---------------------------- Visualization attributes -------------------------------
+
+        fProfiler.BeginPhase("vis attributes");
+
+        logicWorld->SetVisAttributes(G4VisAttributes::GetInvisible());
+
+        for (const auto &coldef: fColors) {
+            auto vol = FindVolume(coldef.vol);
+            if (vol) {
+                if (auto attributes = VisPalette::Instance().Get(coldef.col)) {
+                    vol->SetVisAttributes(attributes);
+                } else {
+                    G4cout << "<><><><><> WARNING: colour >" << coldef.col << "< of " << coldef.vol
+                           << " is not valid, options: red green blue yellow magenta white invisible or r,g,b[,a]"
+                           << G4endl;
+                }
+            } else {
+                G4cout << "<><><><><> WARNING: Logical volume >" << coldef.col << "< does not exist for color command "
+                       << G4endl;
+            }
+        }
+//--------------------------------------Limits ----------------------------------------
+
+        fProfiler.BeginPhase("step limits");
+
+        // below is an example of how to set tracking constraints in a given
+        // logical volume(see also in N02PhysicsList how to setup the processes
+        // G4StepLimiter or G4UserSpecialCuts).
+        // Sets a max Step length in the tracker region, with G4StepLimiter
+        //
+
+        // the limits are made once and kept by the rebuilds, so a /setup/stepMax value stays set
+        if (!stepLimit) {
+            G4double maxStep = 2 * mm;
+            stepLimit = new G4UserLimits(maxStep);
+        }
+        logicWorld->SetUserLimits(stepLimit);
+
+        if (!smallstepLimit) {
+            G4double maxsmallStep = 0.01 * mm;
+            smallstepLimit = new G4UserLimits(maxsmallStep);
+        }
+
+        for (const auto &smallStep: fSmallStep) {
+            auto vol = FindVolume(smallStep.volume);
+            if (vol) {
+                auto &limits = fStepLimits[smallStep.maxStepLength];
+                if (!limits) {
+                    limits.reset(new G4UserLimits(smallStep.maxStepLength));
+                }
+                vol->SetUserLimits(limits.get());
+            } else {
+                G4cout << "<><><><><> ERROR: Logical volume >" << smallStep.volume
+                       << "< does not exist for step command " << G4endl;
+                exit(1);
+            }
+        }
+//--------------------------------------Regions ----------------------------------------
+
+        fProfiler.BeginPhase("regions");
+
+        ConstructRegions();
+    }
+
+
+    void DetectorConstruction::ConstructVolumes() {
 
 ///---------------------------------------------------------------------------
 ///         World
 ///---------------------------------------------------------------------------
 
+        fProfiler.BeginPhase("world");
 
         G4double worldX;
         G4double worldY;
@@ -261,28 +587,41 @@ namespace MuSiG {
         G4cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  " << G4endl;
 
         solidWorld = new G4Box("World", (0.5 * worldX), (0.5 * worldY), (0.5 * worldZ));
-        logicWorld = new G4LogicalVolume(solidWorld, Galactic, "World", nullptr, nullptr, nullptr);
-        physiWorld = new G4PVPlacement(nullptr, G4ThreeVector(), logicWorld, "World", nullptr, false, 0, true);
+        logicWorld = new G4LogicalVolume(solidWorld, fMaterials.Get("Galactic"), "World", nullptr, nullptr, nullptr);
+        RegisterVolume(logicWorld);
+        // with deferred or disabled overlap checks the placements skip pSurfChk
+        const G4bool checkOverlaps = (fOverlapMode == "immediate");
+
+        physiWorld = new G4PVPlacement(nullptr, G4ThreeVector(), logicWorld, "World", nullptr, false, 0, checkOverlaps);
 
 
 ///-----------------------------------------------------------------------------
 ///         Script generated simple boxes and tubes placement
 ///-----------------------------------------------------------------------------
 
+        fProfiler.BeginPhase("definitions");
+
+        ConstructShapes();
+
+        fProfiler.BeginPhase("volumes");
+
+        // volumes placed by the replica loop, and the definition each replica starts from
+        std::unordered_set<std::string> replicaNames;
+        for (const auto &rep: fReplica) {
+            replicaNames.insert(rep.name);
+        }
+        std::unordered_map<std::string, const DetVolume *> volumeDefs;
+
         for (const auto &vol: fVolumes) {
-            auto mother = G4LogicalVolumeStore::GetInstance()->GetVolume(vol.mother);
+            volumeDefs.emplace(vol.name, &vol);
+
+            auto mother = FindVolume(vol.mother);
             if (!mother) {
                 G4cout << "<><><><><> ERROR: Mother named: " << vol.mother << " was not found!" << G4endl;
                 exit(1);
             }
 
-            bool replica = false;
-            for (const auto &rep: fReplica) {
-                if (rep.name == vol.name) {
-                    replica = true;
-                }
-            }
-            if (replica) {
+            if (replicaNames.count(vol.name)) {
                 continue;
             }
 
@@ -294,7 +633,7 @@ namespace MuSiG {
                               mother,       // mother volume
                               false,        // no boolean operation
                               0,            // copy number
-                              true);        // check for overlaps
+                              checkOverlaps); // check for overlaps
 
             G4cout << ">>>>>>>>>> name     : " << vol.name << G4endl;
             G4cout << "           kind     : " << vol.logicVol->GetSolid()->GetEntityType() << G4endl;
@@ -313,8 +652,10 @@ namespace MuSiG {
 ///         Script generated periodic placement wo
 ///-----------------------------------------------------------------------------
 
+        fProfiler.BeginPhase("replicas");
+
         for (const auto &rep: fReplica) {
-            auto replica = G4LogicalVolumeStore::GetInstance()->GetVolume(rep.name);
+            auto replica = FindVolume(rep.name);
             if (!replica) {
                 G4cout << "<><><><><> ERROR: Object to be replicated named: " << rep.name << " was not registered!"
                        << G4endl;
@@ -330,17 +671,16 @@ namespace MuSiG {
             G4RotationMatrix *rot = nullptr;
             G4LogicalVolume *mother = nullptr;
 
-            for (const auto &vol: fVolumes) {
-                if (rep.name == vol.name) {
-                    mother = G4LogicalVolumeStore::GetInstance()->GetVolume(vol.mother);
-                    if (!mother) {
-                        G4cout << "<><><><><> ERROR: Mother named: " << vol.mother << " was not found!" << G4endl;
-                        exit(1);
-                    }
-                    pos = vol.pos;
-                    rot = vol.rot;
-                    break;
+            const auto volDef = volumeDefs.find(rep.name);
+            if (volDef != volumeDefs.end()) {
+                const auto &vol = *volDef->second;
+                mother = FindVolume(vol.mother);
+                if (!mother) {
+                    G4cout << "<><><><><> ERROR: Mother named: " << vol.mother << " was not found!" << G4endl;
+                    exit(1);
                 }
+                pos = vol.pos;
+                rot = vol.rot;
             }
 
 
@@ -365,7 +705,7 @@ namespace MuSiG {
                                   mother,   // mother volume
                                   false,    // no boolean operation
                                   j,        // copy number
-                                  true);    // check for overlaps
+                                  checkOverlaps); // check for overlaps
             }
 
             G4cout << ">>>>>>>>>> group name : " << rep.name << G4endl;
@@ -389,48 +729,55 @@ namespace MuSiG {
 ///         Script generated boolean volumes placement
 ///-----------------------------------------------------------------------------
 
+        fProfiler.BeginPhase("booleans");
+
         if (fBoolMothers.size() <= fBoolVolumes.size()) {
             G4cout << "##########  Boolean mothers: " << fBoolMothers.size() << " pieces, daughters: "
                    << fBoolVolumes.size() << G4endl;
 
+            std::unordered_map<std::string, std::vector<const DetBoolVolume *>> boolDaughters;
+            for (const auto &vol: fBoolVolumes) {
+                boolDaughters[vol.mother].push_back(&vol);
+            }
+
             for (auto &&mother: fBoolMothers) {
-                for (const auto &vol: fBoolVolumes) {
-                    if (vol.mother == mother.name) {
-                        if (!mother.solid) {
-                            G4cout << "<><><><><> ERROR: Mother named: " << vol.mother << " for boolean was not found!"
-                                   << G4endl;
-                            exit(1);
-                        }
-
-                        if (vol.type == "add") {
-                            G4cout << "----------  adding: " << vol.name << " to motherSolid "
-                                   << mother.solid->GetName() << G4endl;
-                            mother.solid = new G4UnionSolid(vol.name, mother.solid, vol.solid, vol.rot, vol.pos);
-                        } else if (vol.type == "sub") {
-                            G4cout << "----------  subtracting : " << vol.name << " to motherSolid "
-                                   << mother.solid->GetName() << G4endl;
-                            mother.solid = new G4SubtractionSolid(vol.name, mother.solid, vol.solid, vol.rot, vol.pos);
-                        } else if (vol.type == "inter") {
-                            G4cout << "----------  intersecting : " << vol.name << " with motherSolid "
-                                   << mother.solid->GetName() << G4endl;
-                            mother.solid = new G4IntersectionSolid(vol.name, mother.solid, vol.solid, vol.rot, vol.pos);
-                        } else {
-                            G4cout << "<><><><><> ERROR: Boolean type: " << vol.type << " was not found!" << G4endl;
-                            exit(1);
-                        }
+                for (const auto volPtr: boolDaughters[mother.name]) {
+                    const auto &vol = *volPtr;
+                    if (!mother.solid) {
+                        G4cout << "<><><><><> ERROR: Mother named: " << vol.mother << " for boolean was not found!"
+                               << G4endl;
+                        exit(1);
+                    }
+
+                    if (vol.type == "add") {
+                        G4cout << "----------  adding: " << vol.name << " to motherSolid "
+                               << mother.solid->GetName() << G4endl;
+                        mother.solid = new G4UnionSolid(vol.name, mother.solid, vol.solid, vol.rot, vol.pos);
+                    } else if (vol.type == "sub") {
+                        G4cout << "----------  subtracting : " << vol.name << " to motherSolid "
+                               << mother.solid->GetName() << G4endl;
+                        mother.solid = new G4SubtractionSolid(vol.name, mother.solid, vol.solid, vol.rot, vol.pos);
+                    } else if (vol.type == "inter") {
+                        G4cout << "----------  intersecting : " << vol.name << " with motherSolid "
+                               << mother.solid->GetName() << G4endl;
+                        mother.solid = new G4IntersectionSolid(vol.name, mother.solid, vol.solid, vol.rot, vol.pos);
+                    } else {
+                        G4cout << "<><><><><> ERROR: Boolean type: " << vol.type << " was not found!" << G4endl;
+                        exit(1);
                     }
                 }
             }
 
 
             for (const auto &vol: fBoolMothers) {
-                auto mother = G4LogicalVolumeStore::GetInstance()->GetVolume(vol.mother);
+                auto mother = FindVolume(vol.mother);
                 if (!mother) {
                     G4cout << "<><><><><> ERROR: Mother named: " << vol.mother << " was not found!" << G4endl;
                     exit(1);
                 }
 
                 auto lVol = new G4LogicalVolume(vol.solid, vol.mat, vol.name);
+                RegisterVolume(lVol);
 
                 new G4PVPlacement(vol.rot,  // rotation
                                   vol.pos,  // position
@@ -439,7 +786,7 @@ namespace MuSiG {
                                   mother,   // mother volume
                                   false,    // no boolean operation
                                   0,        // copy number
-                                  true);    // check for overlaps
+                                  checkOverlaps); // check for overlaps
 
                 G4cout << ">>>>>>>>>> name     : " << vol.name << G4endl;
                 G4cout << "           kind     : " << lVol->GetSolid()->GetEntityType() << G4endl;
@@ -457,195 +804,663 @@ namespace MuSiG {
             exit(1);
         }
 
-///--------------------------------------------------------------------------------- 
-///                         Sensitive detectors
-///--------------------------------------------------------------------------------- 
+//--------------------------------------Sisfe grid construction ----------------------------------------
+        fProfiler.BeginPhase("sisfe grids");
+        for (const auto &fSisfeParams: fSisfeParamsV) {
+            if (fSisfeParams.isPlaced) {
+                ConstructSisfe(fSisfeParams, checkOverlaps);
+            }
+        }
+    }
 
 
+    void DetectorConstruction::ConstructSisfe(const SisfeGeometryDefinition &fSisfeParams, G4bool checkOverlaps) {
+        auto sisfeMother = FindVolume(fSisfeParams.mother);
+        if (!sisfeMother) {
+            G4cout << "<><><><><> ERROR: Mother named: " << fSisfeParams.mother << " was not found!" << G4endl;
+            exit(1);
+        }
+        auto gridRot = fArena.MakeRotation(fSisfeParams.rot);
+        auto &grid = SisfeGrid(fSisfeParams);
+        grid.DefineMaterials(fMaterials.Get(fSisfeParams.matGap), fMaterials.Get(fSisfeParams.matLiqHe),
+                             fMaterials.Get(fSisfeParams.matSi));
+        grid.SetFillMaterial(nullptr);
+        if (fSisfeParams.placement == "lattice") {
+            const auto &lattice = fSisfeParams.lattice;
+            grid.SetLattice(lattice.nX, lattice.nY, lattice.nLayers, lattice.pitch.x(), lattice.pitch.y(),
+                            lattice.cell);
+            if (!lattice.fill.empty()) {
+                grid.SetFillMaterial(fMaterials.Get(lattice.fill));
+            }
+        }
+        grid.SetCheckOverlaps(checkOverlaps);
+        // a detector or scorer attached to a shared pillar volume would see the pillars of the other grids too
+        grid.SetSharePillars(!IsSisfeSensitive(fSisfeParams.name));
+        grid.MakeGeometry(sisfeMother, fSisfeParams.nLiqHe, fSisfeParams.sizeLiqHe.x(),  fSisfeParams.sizeLiqHe.y(),  fSisfeParams.sizeLiqHe.z(), fSisfeParams.sizeSi.x(),  fSisfeParams.sizeSi.y(),  fSisfeParams.sizeSi.z(), fSisfeParams.pos, gridRot);
+        for (auto logic: grid.GetLogicalVolumes()) {
+            RegisterVolume(logic);
+        }
+    }
 
-        auto SDman = G4SDManager::GetSDMpointer();
 
-        G4String trackerDetectorSDname = "muonium/TrackerDetectorSD";
-        auto trackerSD = new TrackerSD(trackerDetectorSDname);
+    sisfeGeometry &DetectorConstruction::SisfeGrid(const SisfeGeometryDefinition &fSisfeParams) {
+        // every grid has its own object, they all use fSisfeRegistry so that the pillars of any grid are identified
+        // and grids with the same pillars share their volumes
+        auto found = fSisfeGrids.find(fSisfeParams.name);
+        if (found == fSisfeGrids.end()) {
+            found = fSisfeGrids.emplace(fSisfeParams.name, sisfeGeometry(fSisfeParams.name)).first;
+            found->second.SetRegistry(fSisfeRegistry);
+            found->second.SetArena(&fArena);
+        }
+        auto &grid = found->second;
+        grid.SetPlacement(fSisfeParams.placement);
+        const auto &colours = fSisfeParams.colours.isInv ? fSisfeParams.colours : fSisfeColParams;
+        if (colours.isInv) {
+            grid.SetColours(colours.ContainerCol, colours.LiqHeCol, colours.SiCol);
+        }
+        grid.SetRegion(fSisfeParams.region.empty() ? nullptr :
+                       G4RegionStore::GetInstance()->FindOrCreateRegion(fSisfeParams.region));
+        return grid;
+    }
 
-        SDman->AddNewDetector(trackerSD);
 
-        for (const auto &detName: fDetName) {
-            auto log = G4LogicalVolumeStore::GetInstance()->GetVolume(detName);
-            if (!log) {
-                G4cout << "<><><><><> ERROR: Logical volume for sensitive detector " << detName << " was not found!"
-                       << G4endl;
-                exit(1);
+    G4bool DetectorConstruction::IsSisfeSensitive(const G4String &grid) const {
+        for (const auto &det: fDetSisfe) {
+            if (det.first == grid) {
+                return true;
             }
-            log->SetSensitiveDetector(trackerSD);
-            G4cout << ">>>>>>>>> Sensitive detector: "
-                   << G4LogicalVolumeStore::GetInstance()->GetVolume(detName)->GetName() << " is set" << G4endl;
         }
-
-//---------------------------- Visualization attributes -------------------------------
+        if (std::find(fStoppingGrids.begin(), fStoppingGrids.end(), grid) != fStoppingGrids.end()) {
+            return true;
+        }
+        for (const auto &name: sisfeGeometry::GetLogicalVolumeNames(grid)) {
+            if ((std::find(fDetName.begin(), fDetName.end(), name) != fDetName.end()) ||
+                (std::find(fStoppingVolumes.begin(), fStoppingVolumes.end(), name) != fStoppingVolumes.end())) {
+                return true;
+            }
+        }
+        return false;
+    }
 
 
-        logicWorld->SetVisAttributes(G4VisAttributes::GetInvisible());
+    void DetectorConstruction::ConstructShapes() {
+        fVolumes.clear();
+        fBoolMothers.clear();
+        fBoolVolumes.clear();
 
-        auto RedVisAtt = new G4VisAttributes(G4Colour(1.0, 0.2, 0.2));
-        auto BlueVisAtt = new G4VisAttributes(G4Colour(0.0, 127, 255));
-        auto GreenVisAtt = new G4VisAttributes(G4Colour(0.5, 1.0, 0.5));
-        auto YellowVisAtt = new G4VisAttributes(G4Colour(1.0, 1.0, 0.));
-        auto MagentaVisAtt = new G4VisAttributes(G4Colour(1.0, 0.0, 1.));
+        for (const auto &def: fShapeDefs) {
+            const auto &params = def.params;
+            auto rot = fArena.MakeRotation(params.rot);
+            auto solid = MakeSolid(def);
+            auto mat = fMaterials.Get(params.mat);
 
-        for (const auto &coldef: fColors) {
-            auto vol = G4LogicalVolumeStore::GetInstance()->GetVolume(coldef.vol);
-            if (vol) {
-                if (coldef.col == "red") vol->SetVisAttributes(RedVisAtt);
-                else if (coldef.col == "green") vol->SetVisAttributes(GreenVisAtt);
-                else if (coldef.col == "blue") vol->SetVisAttributes(BlueVisAtt);
-                else if (coldef.col == "yellow") vol->SetVisAttributes(YellowVisAtt);
-                else if (coldef.col == "magenta") vol->SetVisAttributes(MagentaVisAtt);
-                else if (coldef.col == "invisible") vol->SetVisAttributes(G4VisAttributes::GetInvisible());
+            if (params.booltype == "A") {
+                auto logic = new G4LogicalVolume(solid, mat, params.name);
+                RegisterVolume(logic);
+                fVolumes.push_back(DetVolume{logic, params.name, params.pos, rot, params.mother});
+            } else if (params.booltype == "B") {
+                fBoolMothers.push_back(DetBoolVolume{solid, params.name, mat, params.pos, rot, params.mother, ""});
             } else {
-                G4cout << "<><><><><> WARNING: Logical volume >" << coldef.col << "< does not exist for color command "
-                       << G4endl;
+                fBoolVolumes.push_back(
+                        DetBoolVolume{solid, params.name, mat, params.pos, rot, params.mother, params.booltype});
             }
         }
-//--------------------------------------Limits ----------------------------------------
+    }
 
-        // below is an example of how to set tracking constraints in a given
-        // logical volume(see also in N02PhysicsList how to setup the processes
-        // G4StepLimiter or G4UserSpecialCuts).
-        // Sets a max Step length in the tracker region, with G4StepLimiter
-        //
 
-        G4double maxStep = 2 * mm;
-        stepLimit = new G4UserLimits(maxStep);
-        logicWorld->SetUserLimits(stepLimit);
+    G4VSolid *DetectorConstruction::MakeSolid(const DetShapeDefinition &def) {
+        const auto &params = def.params;
+        if (def.shape == "tubs") {
+            return new G4Tubs(params.name, params.size.x(), params.size.y(), (params.size.z() / 2.), 0. * deg,
+                              360. * deg);
+        }
+        return new G4Box(params.name, (params.size.x() / 2.), (params.size.y() / 2.), (params.size.z() / 2.));
+    }
 
-        G4double maxsmallStep = 0.01 * mm;
-        smallstepLimit = new G4UserLimits(maxsmallStep);
 
-        for (const auto &smallStep: fSmallStep) {
-            auto vol = G4LogicalVolumeStore::GetInstance()->GetVolume(smallStep.volume);
-            if (vol) {
-                vol->SetUserLimits(new G4UserLimits(smallStep.maxStepLength));
-            } else {
-                G4cout << "<><><><><> ERROR: Logical volume >" << smallStep.volume
-                       << "< does not exist for step command " << G4endl;
+    G4bool DetectorConstruction::RebuildChanged() {
+
+        fProfiler.Reset();
+        fProfiler.BeginPhase("changed volumes");
+
+        // physical volume of a changed volume or grid in its mother, nullptr if not placed yet
+        auto findPlaced = [this](const G4String &mother, const G4String &name) -> G4VPhysicalVolume * {
+            auto motherLogic = FindVolume(mother);
+            if (!motherLogic) {
+                return nullptr;
+            }
+            for (std::size_t i = 0; i < motherLogic->GetNoDaughters(); ++i) {
+                auto daughter = motherLogic->GetDaughter(G4int(i));
+                if (daughter->GetName() == name) {
+                    return daughter;
+                }
+            }
+            return nullptr;
+        };
+
+        std::unordered_set<std::string> replicaNames;
+        for (const auto &rep: fReplica) {
+            replicaNames.insert(rep.name);
+        }
+
+        std::vector<G4VPhysicalVolume *> placed;
+        for (const auto &def: fShapeDefs) {
+            if ((def.params.booltype == "A") && fDirtyVolumes.count(def.params.name)) {
+                if (replicaNames.count(def.params.name)) {
+                    return false;
+                }
+                if (auto pv = findPlaced(def.params.mother, def.params.name)) {
+                    placed.push_back(pv);
+                }
+            }
+        }
+        for (const auto &grid: fSisfeParamsV) {
+            const auto built = fSisfeGrids.find(grid.name);
+            if (grid.isPlaced && fDirtySisfe.count(grid.name) && (built != fSisfeGrids.end())) {
+                if (auto pv = findPlaced(grid.mother, built->second.GetNamePhysContainer())) {
+                    placed.push_back(pv);
+                }
+            }
+        }
+
+        // everything below the changed placements goes with them
+        std::unordered_set<G4VPhysicalVolume *> deletedPhysical;
+        std::unordered_set<G4LogicalVolume *> deletedLogical;
+        std::unordered_set<G4VSolid *> deletedSolids;
+        std::vector<G4VPhysicalVolume *> pending(placed);
+        while (!pending.empty()) {
+            auto pv = pending.back();
+            pending.pop_back();
+            deletedPhysical.insert(pv);
+            auto logic = pv->GetLogicalVolume();
+            if (deletedLogical.insert(logic).second) {
+                // a pillar volume shared with a grid that is kept cannot be deleted
+                if (fSisfeRegistry->IsShared(logic)) {
+                    return false;
+                }
+                deletedSolids.insert(logic->GetSolid());
+                for (std::size_t i = 0; i < logic->GetNoDaughters(); ++i) {
+                    pending.push_back(logic->GetDaughter(G4int(i)));
+                }
+            }
+        }
+
+        // volumes and grids placed inside a deleted volume are rebuilt as well, replicas and booleans
+        // are not rebuilt locally
+        auto insideDeleted = [&](const G4String &mother) {
+            return deletedLogical.count(FindVolume(mother)) != 0;
+        };
+        for (const auto &rep: fReplica) {
+            if (deletedLogical.count(FindVolume(rep.name))) {
+                return false;
+            }
+        }
+        for (const auto &def: fShapeDefs) {
+            if (insideDeleted(def.params.mother)) {
+                if (def.params.booltype != "A") {
+                    return false;
+                }
+                fDirtyVolumes.insert(def.params.name);
+            }
+        }
+        for (const auto &grid: fSisfeParamsV) {
+            if (grid.isPlaced && insideDeleted(grid.mother)) {
+                fDirtySisfe.insert(grid.name);
+            }
+        }
+
+        // mothers whose daughters change, their voxels are rebuilt
+        std::unordered_set<G4LogicalVolume *> touched;
+        ReleaseRegions(&deletedLogical);
+        for (auto pv: placed) {
+            auto mother = pv->GetMotherLogical();
+            if (!deletedLogical.count(mother)) {
+                mother->RemoveDaughter(pv);
+                touched.insert(mother);
+            }
+        }
+        for (auto logic: deletedLogical) {
+            const auto indexed = fVolumeIndex.find(logic->GetName());
+            if ((indexed != fVolumeIndex.end()) && (indexed->second == logic)) {
+                fVolumeIndex.erase(indexed);
+            }
+        }
+        // the rotations and parameterisations of the deleted placements go back to the arena
+        for (auto pv: deletedPhysical) {
+            if (pv->IsParameterised()) {
+                fArena.Release(pv->GetParameterisation());
+            }
+            fArena.ReleaseRotation(pv->GetRotation());
+            delete pv;
+        }
+        for (auto logic: deletedLogical) {
+            fSisfeRegistry->Forget(logic);
+            delete logic->GetVoxelHeader();
+            logic->SetVoxelHeader(nullptr);
+            delete logic;
+        }
+        for (auto solid: deletedSolids) {
+            delete solid;
+        }
+
+        const G4bool checkOverlaps = (fOverlapMode == "immediate");
+        std::vector<G4LogicalVolume *> rebuilt;
+
+        // a daughter may be defined before its mother, volumes are placed once their mother exists
+        std::vector<const DetShapeDefinition *> toPlace;
+        for (const auto &def: fShapeDefs) {
+            if ((def.params.booltype == "A") && fDirtyVolumes.count(def.params.name)) {
+                toPlace.push_back(&def);
+            }
+        }
+        while (!toPlace.empty()) {
+            std::vector<const DetShapeDefinition *> waiting;
+            for (auto def: toPlace) {
+                const auto &params = def->params;
+                auto mother = FindVolume(params.mother);
+                if (!mother) {
+                    waiting.push_back(def);
+                    continue;
+                }
+                auto logic = new G4LogicalVolume(MakeSolid(*def), fMaterials.Get(params.mat), params.name);
+                RegisterVolume(logic);
+                new G4PVPlacement(fArena.MakeRotation(params.rot), params.pos, logic, params.name, mother, false, 0,
+                                  checkOverlaps);
+                touched.insert(mother);
+                rebuilt.push_back(logic);
+
+                G4cout << ">>>>>>>>>> rebuilt  : " << params.name << G4endl;
+            }
+            if (waiting.size() == toPlace.size()) {
+                G4cout << "<><><><><> ERROR: Mother named: " << waiting.front()->params.mother << " was not found!"
+                       << G4endl;
                 exit(1);
             }
+            toPlace.swap(waiting);
         }
-//--------------------------------------Sisfe grid construction ----------------------------------------
-        for(const auto &fSisfeParams : fSisfeParamsV)
-        if(fSisfeParams.isPlaced){
-            auto sisfeMother = G4LogicalVolumeStore::GetInstance()->GetVolume(fSisfeParams.mother);
-            auto gridRot = new G4RotationMatrix();
-            gridRot->rotateX(fSisfeParams.rot.x() * deg);
-            gridRot->rotateY(fSisfeParams.rot.y() * deg);
-            gridRot->rotateZ(fSisfeParams.rot.z() * deg);
-            sisfe.SetNameID(fSisfeParams.name);
-            if(fSisfeColParams.isInv){
-                sisfe.SetColours(fSisfeColParams.ContainerCol, fSisfeColParams.LiqHeCol, fSisfeColParams.SiCol);
-            }
-            sisfe.MakeGeometry(sisfeMother, fSisfeParams.nLiqHe, fSisfeParams.sizeLiqHe.x(),  fSisfeParams.sizeLiqHe.y(),  fSisfeParams.sizeLiqHe.z(), fSisfeParams.sizeSi.x(),  fSisfeParams.sizeSi.y(),  fSisfeParams.sizeSi.z(), fSisfeParams.pos, gridRot);
+
+        for (const auto &grid: fSisfeParamsV) {
+            if (grid.isPlaced && fDirtySisfe.count(grid.name)) {
+                ConstructSisfe(grid, checkOverlaps);
+                touched.insert(FindVolume(grid.mother));
+                rebuilt.push_back(FindVolume(sisfeGeometry::GetLogicalVolumeNames(grid.name).front()));
+
+                G4cout << ">>>>>>>>>> rebuilt  : sisfe grid " << grid.name << G4endl;
+            }
         }
-//----------------------------------------------------------------------------
-        return physiWorld;
+
+        // only the touched mothers and the new subtrees are optimised again, not the whole geometry
+        if (G4GeometryManager::GetInstance()->IsGeometryClosed()) {
+            fProfiler.BeginPhase("voxels");
+            std::unordered_set<G4LogicalVolume *> optimised;
+            for (auto logic: rebuilt) {
+                OptimiseVolume(logic, true, optimised);
+            }
+            for (auto logic: touched) {
+                OptimiseVolume(logic, false, optimised);
+            }
+        }
+
+        ConstructAttributes();
+
+        if (fOverlapMode == "deferred") {
+            fProfiler.BeginPhase("overlaps");
+            ValidateOverlaps();
+        }
+
+        fProfiler.EndPhase();
+        fProfiler.PrintSummary();
+
+        fDirtyVolumes.clear();
+        fDirtySisfe.clear();
+
+        return true;
     }
 
 
-    void DetectorConstruction::SetMaxStep(const G4double maxStep) {
-        if (stepLimit && (maxStep > 0.)) {
-            stepLimit->SetMaxAllowedStep(maxStep);
+    void DetectorConstruction::OptimiseVolume(G4LogicalVolume *logic, G4bool recursive,
+                                              std::unordered_set<G4LogicalVolume *> &optimised) {
+        if (!optimised.insert(logic).second) {
+            return;
+        }
+
+        // same criteria as G4GeometryManager::BuildOptimisations()
+        delete logic->GetVoxelHeader();
+        logic->SetVoxelHeader(nullptr);
+        const auto nDaughters = G4int(logic->GetNoDaughters());
+        if ((logic->IsToOptimise() && (nDaughters >= kMinVoxelVolumesLevel1)) ||
+            ((nDaughters == 1) && logic->GetDaughter(0)->IsReplicated() &&
+             (logic->GetDaughter(0)->GetRegularStructureId() != 1))) {
+            logic->SetVoxelHeader(new G4SmartVoxelHeader(logic));
+        }
+
+        if (recursive) {
+            for (G4int i = 0; i < nDaughters; ++i) {
+                OptimiseVolume(logic->GetDaughter(i)->GetLogicalVolume(), true, optimised);
+            }
         }
     }
 
 
-    void DetectorConstruction::SetBoxDefinition(const DetBoxTubsDefinition &params) {
+    void DetectorConstruction::ReleaseGeometry() {
+        fVolumeIndex.clear();
+        fVolumes.clear();
+        fBoolMothers.clear();
+        fBoolVolumes.clear();
 
-        auto mat = G4NistManager::Instance()->FindOrBuildMaterial(params.mat);
+        if (!physiWorld) {
+            return;
+        }
 
-        if (mat && (fVolumes.size() < kMaxVolumes - 1)) {
-            auto rot = new G4RotationMatrix();
-            rot->rotateX(params.rot.x() * deg);
-            rot->rotateY(params.rot.y() * deg);
-            rot->rotateZ(params.rot.z() * deg);
+        ReleaseRegions();
+        fSisfeRegistry->Clear();
+        fSisfeGrids.clear();
 
-            auto sBox = new G4Box(params.name, (params.size.x() / 2.), (params.size.y() / 2.), (params.size.z() / 2.));
+        // the stores own solids and volumes, the arena everything else of the previous build
+        G4GeometryManager::GetInstance()->OpenGeometry();
+        G4PhysicalVolumeStore::GetInstance()->Clean();
+        G4LogicalVolumeStore::GetInstance()->Clean();
+        G4SolidStore::GetInstance()->Clean();
+        fArena.Clear();
 
-            if (params.booltype == "A") {
-                auto lBox = new G4LogicalVolume(sBox, mat, params.name);
-                fVolumes.push_back(DetVolume{lBox, params.name, params.pos, rot, params.mother});
-            } else if (params.booltype == "B") {
-                fBoolMothers.push_back(DetBoolVolume{sBox, params.name, mat, params.pos, rot, params.mother, ""});
-            } else if ((params.booltype == "add") || (params.booltype == "sub") || (params.booltype == "inter")) {
-                fBoolVolumes.push_back(
-                        DetBoolVolume{sBox, params.name, mat, params.pos, rot, params.mother, params.booltype});
-            } else {
-                G4cout << "<><><><><><> ERROR: bool type named " << params.booltype
-                       << " not valid, options: A (alone); B (mother of bool); add, sub, inter with mother " << G4endl;
-                exit(1);
+        physiWorld = nullptr;
+        logicWorld = nullptr;
+        solidWorld = nullptr;
+    }
+
+
+    void DetectorConstruction::ConstructRegions() {
+        for (auto &regionDef: fRegions) {
+            auto region = G4RegionStore::GetInstance()->FindOrCreateRegion(regionDef.name);
+
+            for (const auto &volume: regionDef.volumes) {
+                auto logic = FindVolume(volume);
+                if (!logic) {
+                    G4cout << "<><><><><> ERROR: Logical volume >" << volume << "< does not exist for region "
+                           << regionDef.name << G4endl;
+                    exit(1);
+                }
+                region->AddRootLogicalVolume(logic);
             }
 
-            G4RunManager::GetRunManager()->PhysicsHasBeenModified();
-        } else {
-            if (!mat) {
-                G4cout << "<><><><><><> ERROR: material named " << params.mat << " not found" << G4endl;
+            // volumes of the region without their own G4UserLimits take the ones of the region
+            if (regionDef.maxStep > 0.) {
+                if (!regionDef.limits) {
+                    regionDef.limits = new G4UserLimits();
+                }
+                regionDef.limits->SetMaxAllowedStep(regionDef.maxStep);
+                region->SetUserLimits(regionDef.limits);
             }
-            if (fVolumes.size() >= (kMaxVolumes - 1)) {
-                G4cout << "<><><><><><> ERROR: box exceeds max volumes number" << G4endl;
+
+            if (regionDef.cut > 0.) {
+                if (!regionDef.cuts) {
+                    regionDef.cuts = new G4ProductionCuts();
+                }
+                regionDef.cuts->SetProductionCut(regionDef.cut);
+                region->SetProductionCuts(regionDef.cuts);
             }
-            exit(1);
+
+            G4cout << ">>>>>>>>>> region   : " << regionDef.name << G4endl;
+            G4cout << "           roots    : " << region->GetNumberOfRootVolumes() << G4endl;
+            G4cout << "           max step : " << regionDef.maxStep << " mm" << G4endl;
+            G4cout << "           cut      : " << regionDef.cut << " mm" << G4endl;
         }
     }
 
 
-    void DetectorConstruction::SetTubsDefinition(const DetBoxTubsDefinition &params) {
+    void DetectorConstruction::ReleaseRegions(const std::unordered_set<G4LogicalVolume *> *volumes) {
+        // the root volumes of the regions are deleted with the geometry (all of it, or only the given
+        // volumes), the regions themselves are kept
+        for (const auto &regionDef: fRegions) {
+            auto region = G4RegionStore::GetInstance()->GetRegion(regionDef.name, false);
+            if (!region) {
+                continue;
+            }
+            std::vector<G4LogicalVolume *> roots;
+            auto root = region->GetRootLogicalVolumeIterator();
+            for (std::size_t i = 0; i < region->GetNumberOfRootVolumes(); ++i, ++root) {
+                roots.push_back(*root);
+            }
+            for (auto logic: roots) {
+                if (!volumes || volumes->count(logic)) {
+                    region->RemoveRootLogicalVolume(logic, false);
+                }
+            }
+        }
+    }
 
-        auto mat = G4NistManager::Instance()->FindOrBuildMaterial(params.mat);
 
-        if (mat && (fVolumes.size() < kMaxVolumes - 1)) {
+    DetRegionDefinition &DetectorConstruction::GetRegionDefinition(const G4String &name) {
+        for (auto &regionDef: fRegions) {
+            if (regionDef.name == name) {
+                return regionDef;
+            }
+        }
+        fRegions.emplace_back();
+        fRegions.back().name = name;
+        return fRegions.back();
+    }
 
-            auto rot = new G4RotationMatrix();
-            rot->rotateX(params.rot.x() * deg);
-            rot->rotateY(params.rot.y() * deg);
-            rot->rotateZ(params.rot.z() * deg);
 
-            auto sTubs = new G4Tubs(params.name, params.size.x(), params.size.y(), (params.size.z() / 2.), 0. * deg,
-                                    360. * deg);
+    void DetectorConstruction::RegisterVolume(G4LogicalVolume *logic) {
+        fVolumeIndex[logic->GetName()] = logic;
+    }
 
-            if (params.booltype == "A") {
-                auto lTubs = new G4LogicalVolume(sTubs, mat, params.name);
-                fVolumes.push_back(DetVolume{lTubs, params.name, params.pos, rot, params.mother});
-            } else if (params.booltype == "B") {
-                fBoolMothers.push_back(DetBoolVolume{sTubs, params.name, mat, params.pos, rot, params.mother, ""});
-            } else if ((params.booltype == "add") || (params.booltype == "sub") || (params.booltype == "inter")) {
-                fBoolVolumes.push_back(
-                        DetBoolVolume{sTubs, params.name, mat, params.pos, rot, params.mother, params.booltype});
-            } else {
-                G4cout << "<><><><><><> ERROR: bool type named " << params.booltype
-                       << " not valid, options: A (alone); B (mother of bool); add, sub, inter with mother " << G4endl;
-                exit(1);
+
+    void DetectorConstruction::RegisterTree(G4LogicalVolume *top) {
+        RegisterVolume(top);
+        for (std::size_t i = 0; i < top->GetNoDaughters(); ++i) {
+            auto daughter = top->GetDaughter(G4int(i))->GetLogicalVolume();
+            if (fVolumeIndex[daughter->GetName()] != daughter) {
+                RegisterTree(daughter);
             }
+        }
+    }
 
-            G4RunManager::GetRunManager()->PhysicsHasBeenModified();
-        } else {
-            if (!mat) {
-                G4cout << "<><><><><><> ERROR: material named " << params.mat << " not found" << G4endl;
+
+    std::vector<G4LogicalVolume *> DetectorConstruction::SisfeVolumes(const G4String &grid) {
+        // each logical volume below the container once, the container included; none if the grid is not placed
+        std::vector<G4LogicalVolume *> volumes;
+        const auto found = fSisfeGrids.find(grid);
+        auto container = (found != fSisfeGrids.end()) ? FindVolume(found->second.GetNameLogicContainer()) : nullptr;
+        if (!container) {
+            return volumes;
+        }
+        std::unordered_set<G4LogicalVolume *> visited;
+        std::vector<G4LogicalVolume *> pending{container};
+        while (!pending.empty()) {
+            auto logic = pending.back();
+            pending.pop_back();
+            if (!visited.insert(logic).second) {
+                continue;
+            }
+            volumes.push_back(logic);
+            for (std::size_t i = 0; i < logic->GetNoDaughters(); ++i) {
+                pending.push_back(logic->GetDaughter(G4int(i))->GetLogicalVolume());
+            }
+        }
+        return volumes;
+    }
+
+
+    std::vector<G4LogicalVolume *> DetectorConstruction::VolumesNamed(const G4String &name) {
+        // a volume of a sisfe grid may have one logical volume per pillar (place mode), they are found below the
+        // container of their grid; any other name is one volume of the index
+        for (const auto &grid: fSisfeGrids) {
+            const auto names = sisfeGeometry::GetLogicalVolumeNames(grid.first);
+            if (std::find(names.begin(), names.end(), name) == names.end()) {
+                continue;
+            }
+            std::vector<G4LogicalVolume *> volumes;
+            for (auto logic: SisfeVolumes(grid.first)) {
+                if (logic->GetName() == name) {
+                    volumes.push_back(logic);
+                }
             }
-            if (fVolumes.size() >= kMaxVolumes - 1) {
-                G4cout << "<><><><><><> ERROR: tubs exceeds max volumes number" << G4endl;
+            return volumes;
+        }
+        std::vector<G4LogicalVolume *> volumes;
+        if (auto logic = FindVolume(name)) {
+            volumes.push_back(logic);
+        }
+        return volumes;
+    }
+
+
+    G4LogicalVolume *DetectorConstruction::FindVolume(const G4String &name) {
+        const auto found = fVolumeIndex.find(name);
+        if (found != fVolumeIndex.end()) {
+            return found->second;
+        }
+
+        // volumes not made by the /setup commands are looked up once in the store
+        auto logic = G4LogicalVolumeStore::GetInstance()->GetVolume(name, false);
+        if (logic) {
+            RegisterVolume(logic);
+        }
+        return logic;
+    }
+
+
+    void DetectorConstruction::ValidateOverlaps() {
+        // a geometry validated with fewer points is checked again
+        const auto digest = fSetupDigest.Hex() + "-" + std::to_string(fOverlapSamples);
+
+        if (OverlapValidator::IsValidated(fOverlapCache, digest)) {
+            G4cout << ">>>>>>>>>> Overlaps of geometry " << digest << " already validated, check skipped" << G4endl;
+            return;
+        }
+
+        OverlapValidator validator;
+        validator.SetSamples(fOverlapSamples);
+        validator.SetThreads(fOverlapThreads);
+
+        const auto nOverlaps = validator.Validate(physiWorld);
+        if (nOverlaps == 0) {
+            G4cout << ">>>>>>>>>> No overlaps found in geometry " << digest << G4endl;
+            OverlapValidator::MarkValidated(fOverlapCache, digest);
+        } else {
+            G4cout << "<><><><><> WARNING: " << nOverlaps << " overlapping volumes found in geometry " << digest
+                   << G4endl;
+        }
+    }
+
+
+    void DetectorConstruction::SetMaxStep(const G4double maxStep) {
+        if (stepLimit && (maxStep > 0.)) {
+            stepLimit->SetMaxAllowedStep(maxStep);
+        }
+    }
+
+
+    void DetectorConstruction::SetBoxDefinition(const DetBoxTubsDefinition &params) {
+        SetShapeDefinition("box", params);
+    }
+
+
+    void DetectorConstruction::SetTubsDefinition(const DetBoxTubsDefinition &params) {
+        SetShapeDefinition("tubs", params);
+    }
+
+
+    void DetectorConstruction::CheckShapeDefinition(const DetBoxTubsDefinition &params) {
+        // the material is only looked up by name here, it is built by ConstructShapes() when a volume uses it
+        if (!fMaterials.Has(params.mat)) {
+            G4cout << "<><><><><><> ERROR: material named " << params.mat << " not found, options: NIST (G4_...),";
+            for (const auto &name: fMaterials.GetNames()) {
+                G4cout << " " << name;
             }
+            G4cout << G4endl;
             exit(1);
         }
 
+        if (!((params.booltype == "A") || (params.booltype == "B") || (params.booltype == "add") ||
+              (params.booltype == "sub") || (params.booltype == "inter"))) {
+            G4cout << "<><><><><><> ERROR: bool type named " << params.booltype
+                   << " not valid, options: A (alone); B (mother of bool); add, sub, inter with mother " << G4endl;
+            exit(1);
+        }
+    }
+
+
+    void DetectorConstruction::SetShapeDefinition(const G4String &shape, const DetBoxTubsDefinition &params) {
+
+        AddToDigest(shape, params);
+
+        CheckShapeDefinition(params);
+
+        // solids and volumes are made by ConstructShapes() at build time. A volume defined again replaces
+        // its previous definition and is rebuilt alone by /setup/update, booleans need a full rebuild
+        if (params.booltype == "A") {
+            fDirtyVolumes.insert(params.name);
+            for (auto &def: fShapeDefs) {
+                if ((def.params.booltype == "A") && (def.params.name == params.name)) {
+                    def = DetShapeDefinition{shape, params};
+                    G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+                    return;
+                }
+            }
+        } else {
+            fFullRebuild = true;
+        }
+        fShapeDefs.push_back(DetShapeDefinition{shape, params});
+
+        G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+    }
+
+
+    void DetectorConstruction::ImportShapes(const G4String &fileName) {
+        const auto defs = ShapeTable::Read(fileName);
+        for (const auto &def: defs) {
+            SetShapeDefinition(def.shape, def.params);
+        }
+
+        G4cout << ">>>>>>>>>> " << defs.size() << " boxes and tubs imported from " << fileName << G4endl;
     }
 
 
     void DetectorConstruction::SetRepDefinition(const DetReplica &replica) {
+        fSetupDigest.Add("replica");
+        fSetupDigest.Add(replica.name);
+        fSetupDigest.Add(replica.num);
+        fSetupDigest.Add(replica.type);
+        fSetupDigest.Add(replica.shift);
+
         fReplica.push_back(replica);
+        fFullRebuild = true;
     }
 
 
     void DetectorConstruction::SetDetDefinition(const G4String &name) {
         fDetName.push_back(name);
+
+        // a detector on a sisfe pillar volume keeps the grid from sharing its pillars, see IsSisfeSensitive
+        fSetupDigest.Add("detector");
+        fSetupDigest.Add(name);
+        MarkSisfeVolume(name);
+    }
+
+    void DetectorConstruction::MarkSisfeVolume(const G4String &name) {
+        for (const auto &grid: fSisfeParamsV) {
+            const auto names = sisfeGeometry::GetLogicalVolumeNames(grid.name);
+            if (std::find(names.begin(), names.end(), name) != names.end()) {
+                fDirtySisfe.insert(grid.name);
+            }
+        }
+    }
+
+    void DetectorConstruction::SetSisfeDetector(const G4String &grid, const G4String &pillars) {
+        if (!GetSisfe(grid)) {
+            G4cout << "<><><><><> ERROR: sisfe grid named " << grid << " for sensitive detector was not defined!"
+                   << G4endl;
+            exit(1);
+        }
+        fDetSisfe.emplace_back(grid, pillars);
+
+        // the pillars of a sensitive grid are not shared with other grids, it is built again with its own
+        fSetupDigest.Add("sisfeDetector");
+        fSetupDigest.Add(grid);
+        fDirtySisfe.insert(grid);
     }
 
     void DetectorConstruction::SetColDefinition(const DetColDef &colDef) {
@@ -657,15 +1472,44 @@ namespace MuSiG {
     }
 
     void DetectorConstruction::SetWorldLength(const G4ThreeVector &worldLength) {
+        fSetupDigest.Add("worldsize");
+        fSetupDigest.Add(worldLength);
+
         fWorldLength = worldLength;
+        fFullRebuild = true;
     }
 
     void DetectorConstruction::UpdateGeometry() {
+        // only the changed volumes and grids are rebuilt when the world, the booleans and the replicas are
+        // unchanged; the GDML cache and the worker threads of MT need the whole world again
+        if (physiWorld && !fFullRebuild && fCacheDirectory.empty() && !G4Threading::IsMultithreadedApplication() &&
+            RebuildChanged()) {
+            ConstructSDandField();
+            return;
+        }
+        if (G4Threading::IsMultithreadedApplication()) {
+            // the master builds the new world at the next run, the workers then pick it up and make their
+            // sensitive detectors again
+            G4RunManager::GetRunManager()->ReinitializeGeometry();
+            return;
+        }
         G4RunManager::GetRunManager()->DefineWorldVolume(Construct());
+        ConstructSDandField();
     }
 
 
     void DetectorConstruction::SetSisfe(const SisfeGeometryDefinition &params){
+        fSetupDigest.Add("sisfe");
+        fSetupDigest.Add(params.name);
+        fSetupDigest.Add(params.nLiqHe);
+        fSetupDigest.Add(params.sizeLiqHe);
+        fSetupDigest.Add(params.sizeSi);
+        fSetupDigest.Add(params.pos);
+        fSetupDigest.Add(params.rot);
+        fSetupDigest.Add(params.mother);
+        fSetupDigest.Add(params.isPlaced);
+        fSetupDigest.Add(params.placement);
+
         SisfeGeometryDefinition fSisfeParams;
         fSisfeParams.name = params.name;
         fSisfeParams.nLiqHe = params.nLiqHe;
@@ -675,16 +1519,285 @@ namespace MuSiG {
         fSisfeParams.rot = params.rot;
         fSisfeParams.mother = params.mother;
         fSisfeParams.isPlaced = params.isPlaced;
+        fSisfeParams.placement = params.placement;
+        fSisfeParams.lattice = params.lattice;
+        fSisfeParams.region = params.region;
+        fSisfeParams.matLiqHe = params.matLiqHe;
+        fSisfeParams.matSi = params.matSi;
+        fSisfeParams.matGap = params.matGap;
+        fSisfeParams.colours = params.colours;
+
+        // a grid defined again replaces its previous definition and is rebuilt alone by /setup/update, it keeps
+        // its lattice, region, materials and colours
+        fDirtySisfe.insert(params.name);
+        for (auto &grid: fSisfeParamsV) {
+            if (grid.name == params.name) {
+                fSisfeParams.lattice = grid.lattice;
+                fSisfeParams.region = grid.region;
+                fSisfeParams.matLiqHe = grid.matLiqHe;
+                fSisfeParams.matSi = grid.matSi;
+                fSisfeParams.matGap = grid.matGap;
+                fSisfeParams.colours = grid.colours;
+                grid = fSisfeParams;
+                return;
+            }
+        }
         fSisfeParamsV.push_back(fSisfeParams);
     }
-    void DetectorConstruction::SetSisfeColour(const SisfeColDefinition &params){
-       
+    void DetectorConstruction::SetSisfeLattice(const SisfeLatticeDefinition &params){
+        fSetupDigest.Add("sisfeLattice");
+        fSetupDigest.Add(params.name);
+        fSetupDigest.Add(params.nX);
+        fSetupDigest.Add(params.nY);
+        fSetupDigest.Add(params.nLayers);
+        fSetupDigest.Add(params.pitch);
+        fSetupDigest.Add(params.cell);
+        fSetupDigest.Add(params.fill);
+
+        if (!params.fill.empty() && !fMaterials.Has(params.fill)) {
+            G4cout << "<><><><><><> ERROR: material named " << params.fill << " not found" << G4endl;
+            exit(1);
+        }
+
+        // the lattice applies to the last grid defined with this name
+        for (auto fSisfeParams = fSisfeParamsV.rbegin(); fSisfeParams != fSisfeParamsV.rend(); ++fSisfeParams) {
+            if (fSisfeParams->name == params.name) {
+                fSisfeParams->placement = "lattice";
+                fSisfeParams->lattice = params;
+                fDirtySisfe.insert(params.name);
+                return;
+            }
+        }
+
+        G4cout << "<><><><><> ERROR: sisfe grid named " << params.name << " for lattice was not defined!" << G4endl;
+        exit(1);
+    }
+    void DetectorConstruction::SetSisfeColour(const SisfeColDefinition &params, const G4String &grid){
+        // grids share pillar volumes of the same colour only, the colours are part of the geometry
+        fSetupDigest.Add("sisfeColour");
+        fSetupDigest.Add(grid);
+        fSetupDigest.Add(params.ContainerCol);
+        fSetupDigest.Add(params.LiqHeCol);
+        fSetupDigest.Add(params.SiCol);
+
+        for (const auto &colour: {params.ContainerCol, params.LiqHeCol, params.SiCol}) {
+            if (!VisPalette::Instance().Get(colour)) {
+                G4cout << "<><><><><> WARNING: invalid colour " << colour << " for sisfe, white is used" << G4endl;
+            }
+        }
+
+        // the colours of one grid, or the default of the grids without their own
+        if (!grid.empty()) {
+            for (auto fSisfeParams = fSisfeParamsV.rbegin(); fSisfeParams != fSisfeParamsV.rend(); ++fSisfeParams) {
+                if (fSisfeParams->name == grid) {
+                    fSisfeParams->colours = params;
+                    fDirtySisfe.insert(grid);
+                    return;
+                }
+            }
+            G4cout << "<><><><><> ERROR: sisfe grid named " << grid << " for colours was not defined!" << G4endl;
+            exit(1);
+        }
+
         fSisfeColParams.ContainerCol = params.ContainerCol;
         fSisfeColParams.LiqHeCol = params.LiqHeCol;
         fSisfeColParams.SiCol = params.SiCol;
         fSisfeColParams.isInv = params.isInv;
-        
 
+        for (const auto &fSisfeParams: fSisfeParamsV) {
+            if (!fSisfeParams.colours.isInv) {
+                fDirtySisfe.insert(fSisfeParams.name);
+            }
+        }
+    }
+
+    void DetectorConstruction::SetSisfeMaterials(const G4String &grid, const G4String &LiqHe, const G4String &Si,
+                                                 const G4String &gap) {
+        fSetupDigest.Add("sisfeMaterials");
+        fSetupDigest.Add(grid);
+        fSetupDigest.Add(LiqHe);
+        fSetupDigest.Add(Si);
+        fSetupDigest.Add(gap);
+
+        for (const auto &name: {LiqHe, Si, gap}) {
+            if (!fMaterials.Has(name)) {
+                G4cout << "<><><><><><> ERROR: material named " << name << " not found" << G4endl;
+                exit(1);
+            }
+        }
+
+        for (auto fSisfeParams = fSisfeParamsV.rbegin(); fSisfeParams != fSisfeParamsV.rend(); ++fSisfeParams) {
+            if (fSisfeParams->name == grid) {
+                fSisfeParams->matLiqHe = LiqHe;
+                fSisfeParams->matSi = Si;
+                fSisfeParams->matGap = gap;
+                fDirtySisfe.insert(grid);
+                return;
+            }
+        }
+
+        G4cout << "<><><><><> ERROR: sisfe grid named " << grid << " for materials was not defined!" << G4endl;
+        exit(1);
+    }
+
+    void DetectorConstruction::SetSisfeRegion(const G4String &grid, const G4String &region) {
+        // grids share pillar volumes in the same region only
+        fSetupDigest.Add("sisfeRegion");
+        fSetupDigest.Add(grid);
+        fSetupDigest.Add(region);
+
+        GetRegionDefinition(region);
+
+        for (auto fSisfeParams = fSisfeParamsV.rbegin(); fSisfeParams != fSisfeParamsV.rend(); ++fSisfeParams) {
+            if (fSisfeParams->name == grid) {
+                fSisfeParams->region = region;
+                fDirtySisfe.insert(grid);
+                return;
+            }
+        }
+
+        G4cout << "<><><><><> ERROR: sisfe grid named " << grid << " for region was not defined!" << G4endl;
+        exit(1);
+    }
+
+    const SisfeGeometryDefinition *DetectorConstruction::GetSisfe(const G4String &grid) const {
+        for (auto fSisfeParams = fSisfeParamsV.rbegin(); fSisfeParams != fSisfeParamsV.rend(); ++fSisfeParams) {
+            if (fSisfeParams->name == grid) {
+                return &(*fSisfeParams);
+            }
+        }
+        return nullptr;
+    }
+
+    const DetShapeDefinition *DetectorConstruction::GetShapeDefinition(const G4String &name) const {
+        for (auto def = fShapeDefs.rbegin(); def != fShapeDefs.rend(); ++def) {
+            if (def->params.name == name) {
+                return &(*def);
+            }
+        }
+        return nullptr;
+    }
+
+    void DetectorConstruction::AddStoppingVolume(const G4String &name) {
+        fStoppingVolumes.push_back(name);
+
+        fSetupDigest.Add("stopping");
+        fSetupDigest.Add(name);
+        MarkSisfeVolume(name);
+    }
+
+    void DetectorConstruction::SetStoppingSisfe(const G4String &grid, G4int nX, G4int nY, G4int nZ) {
+        if (!GetSisfe(grid)) {
+            G4cout << "<><><><><> ERROR: sisfe grid named " << grid << " for stopping scorer was not defined!"
+                   << G4endl;
+            exit(1);
+        }
+        fStoppingGrids.push_back(grid);
+        fSetupDigest.Add("sisfeStopping");
+        fSetupDigest.Add(grid);
+        if (nX * nY * nZ > 0) {
+            fStoppingHistogram = StoppingHistogramDefinition{sisfeGeometry::GetLogicalVolumeNames(grid).front(),
+                                                             nX, nY, nZ};
+        }
+    }
+
+    void DetectorConstruction::DefineMaterial(const MaterialDefinition &def) {
+        fSetupDigest.Add("material");
+        fSetupDigest.Add(def.kind);
+        fSetupDigest.Add(def.name);
+        fSetupDigest.Add(def.symbol);
+        fSetupDigest.Add(def.z);
+        fSetupDigest.Add(def.a);
+        fSetupDigest.Add(def.density);
+        fSetupDigest.Add(G4int(def.state));
+        fSetupDigest.Add(def.temperature);
+        fSetupDigest.Add(def.pressure);
+        for (const auto &component: def.components) {
+            fSetupDigest.Add(component.first);
+            fSetupDigest.Add(component.second);
+        }
+
+        fMaterials.Define(def);
+    }
+
+    void DetectorConstruction::LoadMaterials(const G4String &fileName) {
+        const auto defs = MaterialRegistry::ReadDatabase(fileName);
+        for (const auto &def: defs) {
+            DefineMaterial(def);
+        }
+        G4cout << ">>>>>>>>>> " << defs.size() << " material definitions read from " << fileName << G4endl;
+    }
+
+    void DetectorConstruction::ListMaterials() const {
+        G4cout << "Materials available (built on first use), NIST materials G4_... are also available:" << G4endl;
+        for (const auto &name: fMaterials.GetNames()) {
+            G4cout << "    " << name << G4endl;
+        }
+        fMaterials.PrintBuilt();
+    }
+
+    void DetectorConstruction::SetRegionVolume(const G4String &region, const G4String &volume) {
+        GetRegionDefinition(region).volumes.push_back(volume);
+    }
+
+    void DetectorConstruction::SetRegionStep(const G4String &region, G4double maxStep) {
+        auto &regionDef = GetRegionDefinition(region);
+        regionDef.maxStep = maxStep;
+        if (regionDef.limits && (maxStep > 0.)) {
+            regionDef.limits->SetMaxAllowedStep(maxStep);
+        }
+    }
+
+    void DetectorConstruction::SetRegionCut(const G4String &region, G4double cut) {
+        auto &regionDef = GetRegionDefinition(region);
+        regionDef.cut = cut;
+        if (regionDef.cuts && (cut > 0.)) {
+            regionDef.cuts->SetProductionCut(cut);
+        }
+        G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+    }
+
+    void DetectorConstruction::SetProfiling(G4bool enabled) {
+        fProfiler.SetEnabled(enabled);
+    }
+
+    void DetectorConstruction::AddToDigest(const G4String &kind, const DetBoxTubsDefinition &params) {
+        fSetupDigest.Add(kind);
+        fSetupDigest.Add(params.name);
+        fSetupDigest.Add(params.mat);
+        fSetupDigest.Add(params.size);
+        fSetupDigest.Add(params.pos);
+        fSetupDigest.Add(params.rot);
+        fSetupDigest.Add(params.mother);
+        fSetupDigest.Add(params.booltype);
+    }
+
+    void DetectorConstruction::SetOverlapMode(const G4String &mode) {
+        if (!((mode == "immediate") || (mode == "deferred") || (mode == "off"))) {
+            G4cout << "<><><><><> ERROR: overlap mode " << mode << " is invalid, options: immediate, deferred, off"
+                   << G4endl;
+            exit(1);
+        }
+        fOverlapMode = mode;
+    }
+
+    void DetectorConstruction::SetOverlapSamples(G4int samples) {
+        fOverlapSamples = samples;
+    }
+
+    void DetectorConstruction::SetOverlapThreads(G4int threads) {
+        fOverlapThreads = threads;
+    }
+
+    void DetectorConstruction::SetOverlapCache(const G4String &cacheFile) {
+        fOverlapCache = cacheFile;
+    }
+
+    void DetectorConstruction::SetCacheDirectory(const G4String &directory) {
+        if (!directory.empty() && !GeometryCache::IsAvailable()) {
+            G4cout << "<><><><><> WARNING: Geant4 built without GDML, the geometry cache is disabled" << G4endl;
+        }
+        fCacheDirectory = directory;
     }
 }
 
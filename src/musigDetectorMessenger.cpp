@@ -7,9 +7,12 @@
 #include "G4UIcmdWithAString.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
 #include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
 #include "globals.hh"
 
 #include "musigDetectorConstruction.h"
+#include "musigGeometryDescription.h"
 
 
 namespace MuSiG {
@@ -252,6 +255,25 @@ namespace MuSiG {
         fDetDefCmd->SetParameter(detNamePrm);
         fDetDefCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
+        fDetDir = new G4UIdirectory("/setup/detector/");
+        fDetDir->SetGuidance("Sensitive detectors on groups of volumes.");
+
+        fDetSisfeCmd = new G4UIcommand("/setup/detector/sisfe", this);
+        fDetSisfeCmd->SetGuidance("Make the LiqHe and/or Si pillars of a sisfe grid sensitive, whatever their number");
+        fDetSisfeCmd->SetGuidance("and placement: the detector is attached once to each pillar logical volume.");
+
+        auto detGridPrm = new G4UIparameter("nameID", 's', false);
+        detGridPrm->SetGuidance("Grid name string of a /setup/sisfe grid");
+        fDetSisfeCmd->SetParameter(detGridPrm);
+
+        auto detPillarsPrm = new G4UIparameter("pillars", 's', true);
+        detPillarsPrm->SetGuidance("pillars made sensitive");
+        detPillarsPrm->SetParameterCandidates("LiqHe Si all");
+        detPillarsPrm->SetDefaultValue("LiqHe");
+        fDetSisfeCmd->SetParameter(detPillarsPrm);
+
+        fDetSisfeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
 
 //////////////////// Colors ////////////////////////////////  
 
@@ -264,7 +286,7 @@ namespace MuSiG {
 
 
         auto colNamePrm = new G4UIparameter("objCol", 's', false);
-        colNamePrm->SetGuidance("red green blue yellow or invisible");
+        colNamePrm->SetGuidance("red green blue yellow magenta white invisible, or r,g,b[,a] in [0,1]");
         fColorDefCmd->SetParameter(colNamePrm);
 
         fColorDefCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
@@ -368,25 +390,112 @@ namespace MuSiG {
         GridMother->SetGuidance("mother volume");
         fSisfeDefCmd->SetParameter(GridMother);
 
+        auto GridPlacement = new G4UIparameter("GridPlacement", 's', true);
+        GridPlacement->SetGuidance("pillar placement: place = one logical volume per pillar (default), param = shared volumes placed by a parameterisation, replica = replicated (Si + LiqHe) unit cells, lattice = lattice of Si posts set by /setup/sisfeLattice");
+        GridPlacement->SetParameterCandidates("place param replica lattice");
+        GridPlacement->SetDefaultValue("place");
+        fSisfeDefCmd->SetParameter(GridPlacement);
+
         fSisfeDefCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
+        fSisfeLatticeCmd = new G4UIcommand("/setup/sisfeLattice", this);
+        fSisfeLatticeCmd->SetGuidance("Turn a sisfe grid into a 2D/3D lattice of Si posts in a fill material.");
+        fSisfeLatticeCmd->SetGuidance("  the posts have the Si column dimensions of /setup/sisfe, Z is the layer thickness");
+        fSisfeLatticeCmd->SetGuidance("  cells along X and Y, layers along Z, pitch in X and Y (with unit)");
+        fSisfeLatticeCmd->SetGuidance("  square cell: one post per cell; hex cell: every second row shifted by half a pitch");
+
+        auto latticeNamePrm = new G4UIparameter("nameID", 's', false);
+        latticeNamePrm->SetGuidance("Grid name string of a /setup/sisfe grid");
+        fSisfeLatticeCmd->SetParameter(latticeNamePrm);
+
+        auto latticeNXPrm = new G4UIparameter("nX", 'i', false);
+        latticeNXPrm->SetGuidance("Number of cells along X");
+        latticeNXPrm->SetParameterRange("nX > 0");
+        fSisfeLatticeCmd->SetParameter(latticeNXPrm);
+
+        auto latticeNYPrm = new G4UIparameter("nY", 'i', false);
+        latticeNYPrm->SetGuidance("Number of rows along Y, even for a hex cell");
+        latticeNYPrm->SetParameterRange("nY > 0");
+        fSisfeLatticeCmd->SetParameter(latticeNYPrm);
+
+        auto latticeNLayersPrm = new G4UIparameter("nLayers", 'i', false);
+        latticeNLayersPrm->SetGuidance("Number of layers along Z");
+        latticeNLayersPrm->SetParameterRange("nLayers > 0");
+        fSisfeLatticeCmd->SetParameter(latticeNLayersPrm);
+
+        auto pitchXPrm = new G4UIparameter("pitchX", 'd', false);
+        pitchXPrm->SetGuidance("lattice pitch X");
+        fSisfeLatticeCmd->SetParameter(pitchXPrm);
+
+        auto pitchYPrm = new G4UIparameter("pitchY", 'd', false);
+        pitchYPrm->SetGuidance("lattice pitch Y (row spacing)");
+        fSisfeLatticeCmd->SetParameter(pitchYPrm);
+
+        auto unitPitchPrm = new G4UIparameter("unitPitch", 's', false);
+        unitPitchPrm->SetGuidance("unit of pitch");
+        unitPitchPrm->SetParameterCandidates(unitList);
+        fSisfeLatticeCmd->SetParameter(unitPitchPrm);
+
+        auto latticeCellPrm = new G4UIparameter("cell", 's', true);
+        latticeCellPrm->SetGuidance("lattice cell: square or hex");
+        latticeCellPrm->SetParameterCandidates("square hex");
+        latticeCellPrm->SetDefaultValue("square");
+        fSisfeLatticeCmd->SetParameter(latticeCellPrm);
+
+        auto latticeFillPrm = new G4UIparameter("fill", 's', true);
+        latticeFillPrm->SetGuidance("material around the posts, default the sisfe LiqHe");
+        latticeFillPrm->SetDefaultValue("LiqHe");
+        fSisfeLatticeCmd->SetParameter(latticeFillPrm);
+
+        fSisfeLatticeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fSisfeMaterialsCmd = new G4UIcommand("/setup/sisfeMaterials", this);
+        fSisfeMaterialsCmd->SetGuidance("Set the materials of one sisfe grid, e.g. a LiqHe of another density defined");
+        fSisfeMaterialsCmd->SetGuidance("with /setup/material/ for a second target. Grids with the same pillar dimensions,");
+        fSisfeMaterialsCmd->SetGuidance("materials and colours share their pillar volumes, except in the place mode.");
+
+        auto materialsGridPrm = new G4UIparameter("nameID", 's', false);
+        materialsGridPrm->SetGuidance("Grid name string of a /setup/sisfe grid");
+        fSisfeMaterialsCmd->SetParameter(materialsGridPrm);
+
+        auto materialsLiqHePrm = new G4UIparameter("LiqHe", 's', false);
+        materialsLiqHePrm->SetGuidance("material of the LiqHe columns");
+        fSisfeMaterialsCmd->SetParameter(materialsLiqHePrm);
+
+        auto materialsSiPrm = new G4UIparameter("Si", 's', true);
+        materialsSiPrm->SetGuidance("material of the Si columns");
+        materialsSiPrm->SetDefaultValue("G4_Si");
+        fSisfeMaterialsCmd->SetParameter(materialsSiPrm);
+
+        auto materialsGapPrm = new G4UIparameter("gap", 's', true);
+        materialsGapPrm->SetGuidance("material of the container and of the gaps between the columns");
+        materialsGapPrm->SetDefaultValue("Galactic");
+        fSisfeMaterialsCmd->SetParameter(materialsGapPrm);
+
+        fSisfeMaterialsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
         //////////////////// Colors ////////////////////////////////
 
         fColorSisfeDefCmd = new G4UIcommand("/setup/color/sisfe", this);
         fColorSisfeDefCmd->SetGuidance("Name of volume plus color.");
 
         auto containerColNamePrm = new G4UIparameter("containerColor", 's', false);
-        containerColNamePrm->SetGuidance("red green blue yellow magenta or invisible");
+        containerColNamePrm->SetGuidance("red green blue yellow magenta white invisible, or r,g,b[,a] in [0,1]");
         fColorSisfeDefCmd->SetParameter(containerColNamePrm);
 
         auto LiqHeColNamePrm = new G4UIparameter("LiqHeColor", 's', false);
-        LiqHeColNamePrm->SetGuidance("red green blue yellow magenta or invisible");
+        LiqHeColNamePrm->SetGuidance("red green blue yellow magenta white invisible, or r,g,b[,a] in [0,1]");
         fColorSisfeDefCmd->SetParameter(LiqHeColNamePrm);
 
         auto SiColNamePrm = new G4UIparameter("SiColor", 's', false);
-        SiColNamePrm->SetGuidance("red green blue yellow magenta or invisible");
+        SiColNamePrm->SetGuidance("red green blue yellow magenta white invisible, or r,g,b[,a] in [0,1]");
         fColorSisfeDefCmd->SetParameter(SiColNamePrm);
 
+        auto colGridPrm = new G4UIparameter("nameID", 's', true);
+        colGridPrm->SetGuidance("Grid name string of a /setup/sisfe grid, default every grid without its own colours");
+        colGridPrm->SetDefaultValue("");
+        fColorSisfeDefCmd->SetParameter(colGridPrm);
+
         fColorSisfeDefCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
 ////////////////////////////////////////////////////////////
@@ -395,6 +504,395 @@ namespace MuSiG {
         fUpdateCmd->SetGuidance("Update the geometry.");
         fUpdateCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
+        fProfileCmd = new G4UIcmdWithABool("/setup/profile", this);
+        fProfileCmd->SetGuidance("Print wall time, created volumes and memory growth of every geometry construction phase.");
+        fProfileCmd->SetParameterName("profile", true);
+        fProfileCmd->SetDefaultValue(true);
+        fProfileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+//////////////////// Overlap checks ////////////////////////////////
+
+        fOverlapsDir = new G4UIdirectory("/setup/overlaps/");
+        fOverlapsDir->SetGuidance("Overlap checks of the constructed geometry.");
+
+        fOverlapModeCmd = new G4UIcmdWithAString("/setup/overlaps/mode", this);
+        fOverlapModeCmd->SetGuidance("immediate = check every placement when it is made (default)");
+        fOverlapModeCmd->SetGuidance("deferred = place without checks, then check all daughters in parallel");
+        fOverlapModeCmd->SetGuidance("off = no overlap checks");
+        fOverlapModeCmd->SetParameterName("overlapMode", false);
+        fOverlapModeCmd->SetCandidates("immediate deferred off");
+        fOverlapModeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fOverlapSamplesCmd = new G4UIcmdWithAnInteger("/setup/overlaps/samples", this);
+        fOverlapSamplesCmd->SetGuidance("Number of surface points per volume of the deferred overlap check.");
+        fOverlapSamplesCmd->SetParameterName("overlapSamples", false);
+        fOverlapSamplesCmd->SetRange("overlapSamples>0");
+        fOverlapSamplesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fOverlapThreadsCmd = new G4UIcmdWithAnInteger("/setup/overlaps/threads", this);
+        fOverlapThreadsCmd->SetGuidance("Threads of the deferred overlap check, 0 = one per core.");
+        fOverlapThreadsCmd->SetParameterName("overlapThreads", false);
+        fOverlapThreadsCmd->SetRange("overlapThreads>=0");
+        fOverlapThreadsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fOverlapCacheCmd = new G4UIcmdWithAString("/setup/overlaps/cache", this);
+        fOverlapCacheCmd->SetGuidance("File listing the digests of geometries already validated, with their sample count.");
+        fOverlapCacheCmd->SetGuidance("A deferred check of a listed geometry is skipped, a passed check is added.");
+        fOverlapCacheCmd->SetParameterName("overlapCache", false);
+        fOverlapCacheCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+//////////////////// Geometry cache ////////////////////////////////
+
+        fGeometryCacheCmd = new G4UIcmdWithAString("/setup/geometryCache", this);
+        fGeometryCacheCmd->SetGuidance("Directory of the GDML geometry cache.");
+        fGeometryCacheCmd->SetGuidance("The constructed world is stored there under the digest of the /setup definitions");
+        fGeometryCacheCmd->SetGuidance("and read back instead of being constructed when the same geometry is set up again.");
+        fGeometryCacheCmd->SetParameterName("cacheDirectory", false);
+        fGeometryCacheCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+//////////////////// Compiled geometry description ////////////////////////////////
+
+        fCompileCmd = new G4UIcommand("/setup/compile", this);
+        fCompileCmd->SetGuidance("Compile a /setup macro into a binary geometry description for /setup/load.");
+        fCompileCmd->SetGuidance("Boxes, tubs, replicas and sisfe grids are stored as definitions with the units applied,");
+        fCompileCmd->SetGuidance("any other command as a command line applied at its place.");
+
+        auto compileMacroPrm = new G4UIparameter("macroFile", 's', false);
+        compileMacroPrm->SetGuidance("macro to compile");
+        fCompileCmd->SetParameter(compileMacroPrm);
+
+        auto compileFilePrm = new G4UIparameter("fileName", 's', false);
+        compileFilePrm->SetGuidance("compiled description written");
+        fCompileCmd->SetParameter(compileFilePrm);
+
+        fCompileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fLoadCmd = new G4UIcmdWithAString("/setup/load", this);
+        fLoadCmd->SetGuidance("Load a geometry description made by /setup/compile, as if its macro was executed.");
+        fLoadCmd->SetParameterName("fileName", false);
+        fLoadCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fImportCmd = new G4UIcmdWithAString("/setup/import", this);
+        fImportCmd->SetGuidance("Define the boxes and tubs of a CSV or TSV table in one batch, one per line:");
+        fImportCmd->SetGuidance("  shape,name,material,sizeX,sizeY,sizeZ,sizeUnit,posX,posY,posZ,posUnit,rotX,rotY,rotZ,mother[,booltype]");
+        fImportCmd->SetGuidance("  with the fields of /setup/box and /setup/tubs, shape box or tubs.");
+        fImportCmd->SetParameterName("fileName", false);
+        fImportCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+//////////////////// Materials ////////////////////////////////
+
+        fMaterialDir = new G4UIdirectory("/setup/material/");
+        fMaterialDir->SetGuidance("User defined materials, built the first time a volume uses them.");
+        fMaterialDir->SetGuidance("A material already in use cannot be redefined, give a variant a new name.");
+
+        fMaterialElementCmd = new G4UIcommand("/setup/material/element", this);
+        fMaterialElementCmd->SetGuidance("Define an element.");
+
+        auto elementNamePrm = new G4UIparameter("name", 's', false);
+        elementNamePrm->SetGuidance("name of the element");
+        fMaterialElementCmd->SetParameter(elementNamePrm);
+
+        auto elementSymbolPrm = new G4UIparameter("symbol", 's', false);
+        elementSymbolPrm->SetGuidance("chemical symbol");
+        fMaterialElementCmd->SetParameter(elementSymbolPrm);
+
+        auto elementZPrm = new G4UIparameter("Z", 'd', false);
+        elementZPrm->SetGuidance("atomic number");
+        elementZPrm->SetParameterRange("Z>=1.");
+        fMaterialElementCmd->SetParameter(elementZPrm);
+
+        auto elementAPrm = new G4UIparameter("A", 'd', false);
+        elementAPrm->SetGuidance("molar mass in g/mole");
+        elementAPrm->SetParameterRange("A>0.");
+        fMaterialElementCmd->SetParameter(elementAPrm);
+
+        fMaterialElementCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        // density, state, temperature and pressure, common to all the materials
+        auto densityUnitList = G4UIcommand::UnitsList(G4UIcommand::CategoryOf("g/cm3"));
+        auto pressureUnitList = G4UIcommand::UnitsList(G4UIcommand::CategoryOf("bar"));
+        auto setConditions = [&densityUnitList, &pressureUnitList](G4UIcommand *cmd, G4bool optional) {
+            auto densityPrm = new G4UIparameter("density", 'd', false);
+            densityPrm->SetGuidance("density");
+            densityPrm->SetParameterRange("density>0.");
+            cmd->SetParameter(densityPrm);
+
+            auto densityUnitPrm = new G4UIparameter("densityUnit", 's', false);
+            densityUnitPrm->SetGuidance("unit of density");
+            densityUnitPrm->SetParameterCandidates(densityUnitList);
+            cmd->SetParameter(densityUnitPrm);
+
+            auto statePrm = new G4UIparameter("state", 's', optional);
+            statePrm->SetGuidance("state of the material");
+            statePrm->SetParameterCandidates("solid liquid gas undefined");
+            statePrm->SetDefaultValue("undefined");
+            cmd->SetParameter(statePrm);
+
+            auto temperaturePrm = new G4UIparameter("temperature", 'd', optional);
+            temperaturePrm->SetGuidance("temperature in kelvin, 0 for NTP");
+            temperaturePrm->SetParameterRange("temperature>=0.");
+            temperaturePrm->SetDefaultValue(0.);
+            cmd->SetParameter(temperaturePrm);
+
+            auto pressurePrm = new G4UIparameter("pressure", 'd', optional);
+            pressurePrm->SetGuidance("pressure, 0 for 1 atm");
+            pressurePrm->SetParameterRange("pressure>=0.");
+            pressurePrm->SetDefaultValue(0.);
+            cmd->SetParameter(pressurePrm);
+
+            auto pressureUnitPrm = new G4UIparameter("pressureUnit", 's', optional);
+            pressureUnitPrm->SetGuidance("unit of pressure");
+            pressureUnitPrm->SetParameterCandidates(pressureUnitList);
+            pressureUnitPrm->SetDefaultValue("bar");
+            cmd->SetParameter(pressureUnitPrm);
+        };
+
+        fMaterialSimpleCmd = new G4UIcommand("/setup/material/simple", this);
+        fMaterialSimpleCmd->SetGuidance("Define a material of one element, e.g.");
+        fMaterialSimpleCmd->SetGuidance("  /setup/material/simple LiqHe_2K 2 4.0 0.1462 g/cm3 liquid 2.0 1 bar");
+
+        auto simpleNamePrm = new G4UIparameter("name", 's', false);
+        simpleNamePrm->SetGuidance("name of the material");
+        fMaterialSimpleCmd->SetParameter(simpleNamePrm);
+
+        auto simpleZPrm = new G4UIparameter("Z", 'd', false);
+        simpleZPrm->SetGuidance("atomic number");
+        simpleZPrm->SetParameterRange("Z>=1.");
+        fMaterialSimpleCmd->SetParameter(simpleZPrm);
+
+        auto simpleAPrm = new G4UIparameter("A", 'd', false);
+        simpleAPrm->SetGuidance("molar mass in g/mole");
+        simpleAPrm->SetParameterRange("A>0.");
+        fMaterialSimpleCmd->SetParameter(simpleAPrm);
+
+        setConditions(fMaterialSimpleCmd, true);
+        fMaterialSimpleCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fMaterialCompoundCmd = new G4UIcommand("/setup/material/compound", this);
+        fMaterialCompoundCmd->SetGuidance("Define a material from the number of atoms of each element, e.g.");
+        fMaterialCompoundCmd->SetGuidance("  /setup/material/compound CO2_10atm 18.3 mg/cm3 gas 300 10 atmosphere \"C 1 O 2\"");
+
+        auto compoundNamePrm = new G4UIparameter("name", 's', false);
+        compoundNamePrm->SetGuidance("name of the material");
+        fMaterialCompoundCmd->SetParameter(compoundNamePrm);
+
+        setConditions(fMaterialCompoundCmd, false);
+
+        auto compoundComponentsPrm = new G4UIparameter("components", 's', false);
+        compoundComponentsPrm->SetGuidance("quoted list of element and number of atoms");
+        fMaterialCompoundCmd->SetParameter(compoundComponentsPrm);
+
+        fMaterialCompoundCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fMaterialMixtureCmd = new G4UIcommand("/setup/material/mixture", this);
+        fMaterialMixtureCmd->SetGuidance("Define a material from the mass fractions of materials or elements, e.g.");
+        fMaterialMixtureCmd->SetGuidance("  /setup/material/mixture HeN2 0.2 g/cm3 liquid 4.2 1 bar \"LiqHe 0.99 G4_N 0.01\"");
+
+        auto mixtureNamePrm = new G4UIparameter("name", 's', false);
+        mixtureNamePrm->SetGuidance("name of the material");
+        fMaterialMixtureCmd->SetParameter(mixtureNamePrm);
+
+        setConditions(fMaterialMixtureCmd, false);
+
+        auto mixtureComponentsPrm = new G4UIparameter("components", 's', false);
+        mixtureComponentsPrm->SetGuidance("quoted list of material or element and mass fraction");
+        fMaterialMixtureCmd->SetParameter(mixtureComponentsPrm);
+
+        fMaterialMixtureCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fMaterialLoadCmd = new G4UIcmdWithAString("/setup/material/load", this);
+        fMaterialLoadCmd->SetGuidance("Read a material database file, one definition per line:");
+        fMaterialLoadCmd->SetGuidance("  <element|simple|compound|mixture> <arguments of /setup/material/...>");
+        fMaterialLoadCmd->SetGuidance("The materials are only built when a volume uses them.");
+        fMaterialLoadCmd->SetParameterName("fileName", false);
+        fMaterialLoadCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fMaterialListCmd = new G4UIcmdWithoutParameter("/setup/material/list", this);
+        fMaterialListCmd->SetGuidance("List the materials defined and the ones built.");
+        fMaterialListCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+//////////////////// Regions ////////////////////////////////
+
+        fRegionDir = new G4UIdirectory("/setup/region/");
+        fRegionDir->SetGuidance("Regions with their own step limit and production cuts.");
+        fRegionDir->SetGuidance("Volumes of a region without a /setup/steplimit take the step limit of the region.");
+
+        fRegionAddCmd = new G4UIcommand("/setup/region/add", this);
+        fRegionAddCmd->SetGuidance("Add a volume (and its daughters) to a region, created if needed.");
+
+        auto regionNamePrm = new G4UIparameter("region", 's', false);
+        regionNamePrm->SetGuidance("name of the region");
+        fRegionAddCmd->SetParameter(regionNamePrm);
+
+        auto regionVolumePrm = new G4UIparameter("volume", 's', false);
+        regionVolumePrm->SetGuidance("name of the root volume");
+        fRegionAddCmd->SetParameter(regionVolumePrm);
+
+        fRegionAddCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fRegionStepCmd = new G4UIcommand("/setup/region/stepMax", this);
+        fRegionStepCmd->SetGuidance("Max step length in a region (needs G4StepLimiter in the physics list).");
+
+        auto regionStepNamePrm = new G4UIparameter("region", 's', false);
+        regionStepNamePrm->SetGuidance("name of the region");
+        fRegionStepCmd->SetParameter(regionStepNamePrm);
+
+        auto regionStepPrm = new G4UIparameter("stepMax", 'd', false);
+        regionStepPrm->SetGuidance("max step length");
+        regionStepPrm->SetParameterRange("stepMax>0.");
+        fRegionStepCmd->SetParameter(regionStepPrm);
+
+        auto regionStepUnitPrm = new G4UIparameter("unit", 's', false);
+        regionStepUnitPrm->SetGuidance("unit of length");
+        regionStepUnitPrm->SetParameterCandidates(unitList);
+        fRegionStepCmd->SetParameter(regionStepUnitPrm);
+
+        fRegionStepCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fRegionCutCmd = new G4UIcommand("/setup/region/cut", this);
+        fRegionCutCmd->SetGuidance("Production cut of gamma, e-, e+ and proton in a region.");
+
+        auto regionCutNamePrm = new G4UIparameter("region", 's', false);
+        regionCutNamePrm->SetGuidance("name of the region");
+        fRegionCutCmd->SetParameter(regionCutNamePrm);
+
+        auto regionCutPrm = new G4UIparameter("cut", 'd', false);
+        regionCutPrm->SetGuidance("range cut");
+        regionCutPrm->SetParameterRange("cut>0.");
+        fRegionCutCmd->SetParameter(regionCutPrm);
+
+        auto regionCutUnitPrm = new G4UIparameter("unit", 's', false);
+        regionCutUnitPrm->SetGuidance("unit of length");
+        regionCutUnitPrm->SetParameterCandidates(unitList);
+        fRegionCutCmd->SetParameter(regionCutUnitPrm);
+
+        fRegionCutCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fRegionSisfeCmd = new G4UIcommand("/setup/region/sisfe", this);
+        fRegionSisfeCmd->SetGuidance("Make the container of a sisfe grid the root of a region.");
+
+        auto regionGridPrm = new G4UIparameter("nameID", 's', false);
+        regionGridPrm->SetGuidance("Grid name string of a /setup/sisfe grid");
+        fRegionSisfeCmd->SetParameter(regionGridPrm);
+
+        auto regionGridRegionPrm = new G4UIparameter("region", 's', true);
+        regionGridRegionPrm->SetGuidance("name of the region, default the grid name");
+        regionGridRegionPrm->SetDefaultValue("");
+        fRegionSisfeCmd->SetParameter(regionGridRegionPrm);
+
+        fRegionSisfeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+//////////////////// Stopping scorer ////////////////////////////////
+
+        fStoppingDir = new G4UIdirectory("/setup/stopping/");
+        fStoppingDir->SetGuidance("Counts of the muon (mu+, mu-, Mu) stops per volume and copy number,");
+        fStoppingDir->SetGuidance("summed over the threads, instead of writing every hit.");
+
+        fStoppingVolumeCmd = new G4UIcmdWithAString("/setup/stopping/volume", this);
+        fStoppingVolumeCmd->SetGuidance("Count the stops in the logical volume(s) of that name.");
+        fStoppingVolumeCmd->SetParameterName("volume", false);
+        fStoppingVolumeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fStoppingSisfeCmd = new G4UIcommand("/setup/stopping/sisfe", this);
+        fStoppingSisfeCmd->SetGuidance("Count the stops in every volume of a sisfe grid and histogram them");
+        fStoppingSisfeCmd->SetGuidance("in the frame of its container (0 bins for no histogram).");
+
+        auto stoppingGridPrm = new G4UIparameter("nameID", 's', false);
+        stoppingGridPrm->SetGuidance("Grid name string of a /setup/sisfe grid");
+        fStoppingSisfeCmd->SetParameter(stoppingGridPrm);
+
+        for (auto axis: {"nX", "nY", "nZ"}) {
+            auto stoppingBinsPrm = new G4UIparameter(axis, 'i', true);
+            stoppingBinsPrm->SetGuidance("number of bins of the histogram");
+            stoppingBinsPrm->SetParameterRange((G4String(axis) + ">=0").c_str());
+            stoppingBinsPrm->SetDefaultValue(0);
+            fStoppingSisfeCmd->SetParameter(stoppingBinsPrm);
+        }
+
+        fStoppingSisfeCmd->AvailableForStates(G4State_PreInit);
+
+        fStoppingPrintCmd = new G4UIcmdWithoutParameter("/setup/stopping/print", this);
+        fStoppingPrintCmd->SetGuidance("Print the stops per volume and the projections of the histogram.");
+        fStoppingPrintCmd->AvailableForStates(G4State_Idle);
+
+        fStoppingWriteCmd = new G4UIcmdWithAString("/setup/stopping/write", this);
+        fStoppingWriteCmd->SetGuidance("Write the stops per volume and the histogram to a CSV file.");
+        fStoppingWriteCmd->SetParameterName("fileName", false);
+        fStoppingWriteCmd->AvailableForStates(G4State_Idle);
+
+        fStoppingResetCmd = new G4UIcmdWithoutParameter("/setup/stopping/reset", this);
+        fStoppingResetCmd->SetGuidance("Reset the counts, e.g. between the runs of a scan.");
+        fStoppingResetCmd->AvailableForStates(G4State_Idle);
+
+//////////////////// Parameter scan ////////////////////////////////
+
+        fScan = new GeometryScan(fDetector);
+
+        fScanDir = new G4UIdirectory("/setup/scan/");
+        fScanDir->SetGuidance("Scan of one geometry parameter, run in one process after /run/initialize.");
+        fScanDir->SetGuidance("At every point the geometry is updated, the output file set and the events run.");
+
+        fScanParameterCmd = new G4UIcommand("/setup/scan/parameter", this);
+        fScanParameterCmd->SetGuidance("Parameter of the scan and its range.");
+        fScanParameterCmd->SetGuidance("sisfe fields: nLiqHe, sizeLiqHe.x/y/z, sizeSi.x/y/z, pos.x/y/z, rot.x/y/z");
+        fScanParameterCmd->SetGuidance("box/tubs fields: size.x/y/z, pos.x/y/z, rot.x/y/z (rot in deg), booltype A volumes only");
+        fScanParameterCmd->SetGuidance("ui: name is a UI command taking a value and unit, e.g. /gun/momentum");
+
+        auto scanKindPrm = new G4UIparameter("kind", 's', false);
+        scanKindPrm->SetGuidance("kind of the scanned definition");
+        scanKindPrm->SetParameterCandidates("sisfe box tubs ui");
+        fScanParameterCmd->SetParameter(scanKindPrm);
+
+        auto scanNamePrm = new G4UIparameter("name", 's', false);
+        scanNamePrm->SetGuidance("name of the grid or volume, the command for ui");
+        fScanParameterCmd->SetParameter(scanNamePrm);
+
+        auto scanFieldPrm = new G4UIparameter("field", 's', false);
+        scanFieldPrm->SetGuidance("scanned field, - for ui");
+        fScanParameterCmd->SetParameter(scanFieldPrm);
+
+        auto scanFromPrm = new G4UIparameter("from", 'd', false);
+        scanFromPrm->SetGuidance("first value");
+        fScanParameterCmd->SetParameter(scanFromPrm);
+
+        auto scanToPrm = new G4UIparameter("to", 'd', false);
+        scanToPrm->SetGuidance("last value (included)");
+        fScanParameterCmd->SetParameter(scanToPrm);
+
+        auto scanStepPrm = new G4UIparameter("step", 'd', false);
+        scanStepPrm->SetGuidance("step between the values");
+        scanStepPrm->SetParameterRange("step>0.");
+        fScanParameterCmd->SetParameter(scanStepPrm);
+
+        auto scanUnitPrm = new G4UIparameter("unit", 's', true);
+        scanUnitPrm->SetGuidance("unit of the values (deg for rotations), - for none");
+        scanUnitPrm->SetDefaultValue("mm");
+        fScanParameterCmd->SetParameter(scanUnitPrm);
+
+        fScanParameterCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fScanEventsCmd = new G4UIcmdWithAnInteger("/setup/scan/beamOn", this);
+        fScanEventsCmd->SetGuidance("Number of events run at every point of the scan.");
+        fScanEventsCmd->SetParameterName("events", false);
+        fScanEventsCmd->SetRange("events>=0");
+        fScanEventsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fScanOutputCmd = new G4UIcmdWithAString("/setup/scan/output", this);
+        fScanOutputCmd->SetGuidance("Prefix of the output file of every point, <prefix>_<point>.");
+        fScanOutputCmd->SetParameterName("prefix", false);
+        fScanOutputCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fScanOutputCommandCmd = new G4UIcmdWithAString("/setup/scan/outputCommand", this);
+        fScanOutputCommandCmd->SetGuidance("UI command setting the output file name, default /run/outputFilename.");
+        fScanOutputCommandCmd->SetParameterName("command", false);
+        fScanOutputCommandCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+        fScanRunCmd = new G4UIcmdWithoutParameter("/setup/scan/run", this);
+        fScanRunCmd->SetGuidance("Run the scan.");
+        fScanRunCmd->SetGuidance("The table at the end gives the build and run time of every point; under MT the build is");
+        fScanRunCmd->SetGuidance("the geometry of the master, the worker threads rebuild theirs at the start of the run.");
+        fScanRunCmd->AvailableForStates(G4State_Idle);
+
     }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -406,9 +904,48 @@ namespace MuSiG {
         delete fBoxDefCmd;
         delete fRepDefCmd;
         delete fDetDefCmd;
+        delete fDetSisfeCmd;
+        delete fDetDir;
         delete fColorDefCmd;
         delete fStepDefCmd;
         delete fUpdateCmd;
+        delete fSisfeLatticeCmd;
+        delete fSisfeMaterialsCmd;
+        delete fProfileCmd;
+        delete fOverlapModeCmd;
+        delete fOverlapSamplesCmd;
+        delete fOverlapThreadsCmd;
+        delete fOverlapCacheCmd;
+        delete fOverlapsDir;
+        delete fGeometryCacheCmd;
+        delete fCompileCmd;
+        delete fLoadCmd;
+        delete fImportCmd;
+        delete fMaterialElementCmd;
+        delete fMaterialSimpleCmd;
+        delete fMaterialCompoundCmd;
+        delete fMaterialMixtureCmd;
+        delete fMaterialLoadCmd;
+        delete fMaterialListCmd;
+        delete fMaterialDir;
+        delete fRegionAddCmd;
+        delete fRegionStepCmd;
+        delete fRegionCutCmd;
+        delete fRegionSisfeCmd;
+        delete fRegionDir;
+        delete fStoppingVolumeCmd;
+        delete fStoppingSisfeCmd;
+        delete fStoppingPrintCmd;
+        delete fStoppingWriteCmd;
+        delete fStoppingResetCmd;
+        delete fStoppingDir;
+        delete fScanParameterCmd;
+        delete fScanEventsCmd;
+        delete fScanOutputCmd;
+        delete fScanOutputCommandCmd;
+        delete fScanRunCmd;
+        delete fScanDir;
+        delete fScan;
         delete fSetupDir;
     }
 
@@ -419,72 +956,13 @@ namespace MuSiG {
         if (command == fStepMaxCmd) {
             fDetector->SetMaxStep(G4UIcmdWithADoubleAndUnit::GetNewDoubleValue(newValue));
         } else if (command == fBoxDefCmd) {
-            G4String nam;
-            G4String mat;
-            G4double v1, v2, v3;
-            G4String unt_size;
-            G4double p1, p2, p3;
-            G4String unt_pos;
-            G4double d1, d2, d3;
-            G4String mother;
-            G4String isbool;
-
-            std::istringstream is(newValue);
-
-            is >> nam >> mat >> v1 >> v2 >> v3 >> unt_size >> p1 >> p2 >> p3 >> unt_pos >> d1 >> d2 >> d3 >> mother
-               >> isbool;
-
-            G4ThreeVector vec1(v1, v2, v3);
-            vec1 *= G4UIcommand::ValueOf(unt_size);
-
-            G4ThreeVector vec2(p1, p2, p3);
-            vec2 *= G4UIcommand::ValueOf(unt_pos);
-
-            G4ThreeVector vec3(d1, d2, d3);
-
-            fDetector->SetBoxDefinition(DetBoxTubsDefinition{nam, mat, vec1, vec2, vec3, mother, isbool});
+            fDetector->SetBoxDefinition(GeometryDescription::ParseShape(newValue));
 
         } else if (command == fTubsDefCmd) {
-            G4String nam;
-            G4String mat;
-            G4double r1, r2, h;
-            G4String unt_size;
-            G4double p1, p2, p3;
-            G4String unt_pos;
-            G4double d1, d2, d3;
-            G4String mother;
-            G4String isbool;
-
-            std::istringstream is(newValue);
-
-            is >> nam >> mat >> r1 >> r2 >> h >> unt_size >> p1 >> p2 >> p3 >> unt_pos >> d1 >> d2 >> d3 >> mother
-               >> isbool;
-
-            G4ThreeVector vec1(r1, r2, h);
-            vec1 *= G4UIcommand::ValueOf(unt_size);
-
-            G4ThreeVector vec2(p1, p2, p3);
-            vec2 *= G4UIcommand::ValueOf(unt_pos);
-
-            G4ThreeVector vec3(d1, d2, d3);
-
-            fDetector->SetTubsDefinition(DetBoxTubsDefinition{nam, mat, vec1, vec2, vec3, mother, isbool});
+            fDetector->SetTubsDefinition(GeometryDescription::ParseShape(newValue));
 
         } else if (command == fRepDefCmd) {
-            G4String nam;
-            G4String typ;
-            G4double v1, v2, v3;
-            G4int num;
-            G4String unt_pos;
-
-            std::istringstream is(newValue);
-
-            is >> nam >> num >> typ >> v1 >> v2 >> v3 >> unt_pos;
-
-            G4ThreeVector vec1(v1, v2, v3);
-            vec1 *= G4UIcommand::ValueOf(unt_pos);
-
-            fDetector->SetRepDefinition(DetReplica{nam, num, typ, vec1});
+            fDetector->SetRepDefinition(GeometryDescription::ParseReplica(newValue));
 
         } else if (command == fWorldLengthCmd) {
             G4double d1, d2, d3;
@@ -502,6 +980,12 @@ namespace MuSiG {
             is >> nam;
 
             fDetector->SetDetDefinition(nam);
+        } else if (command == fDetSisfeCmd) {
+            G4String grid, pillars;
+            std::istringstream is(newValue);
+            is >> grid >> pillars;
+
+            fDetector->SetSisfeDetector(grid, pillars);
         } else if (command == fColorDefCmd) {
             G4String nam, color;
             std::istringstream is(newValue);
@@ -516,42 +1000,115 @@ namespace MuSiG {
 
             fDetector->SetSmallStep(DetMaxStepLength{nam, step});
         } else if (command == fSisfeDefCmd){
-            G4String name;
-            G4int nLiqHe;
-            G4double LiqHeDimX, LiqHeDimY, LiqHeDimZ;
-            G4String LiqHeSizeDim;
-            G4double SiDimX, SiDimY, SiDimZ;
-            G4String SiSizeDim;
-            G4double posX, posY, posZ;
-            G4String GridPosDim;
-            G4double rotX, rotY, rotZ;
-            G4String mother;
-
+            fDetector->SetSisfe(GeometryDescription::ParseSisfe(newValue));
+        } else if (command == fSisfeLatticeCmd){
+            fDetector->SetSisfeLattice(GeometryDescription::ParseSisfeLattice(newValue));
+        } else if (command == fSisfeMaterialsCmd){
+            G4String grid, LiqHe, Si, gap;
             std::istringstream is(newValue);
-            is >> name >> nLiqHe >> LiqHeDimX >> LiqHeDimY >> LiqHeDimZ >> LiqHeSizeDim >> SiDimX >> SiDimY >> SiDimZ >> SiSizeDim >> posX >> posY >> posZ >> GridPosDim >> rotX >> rotY >> rotZ >> mother;
-
-            G4ThreeVector sizeLiqHe(LiqHeDimX, LiqHeDimY, LiqHeDimZ);
-            sizeLiqHe *= G4UIcommand::ValueOf(LiqHeSizeDim);
-
-            G4ThreeVector sizeSi(SiDimX, SiDimY, SiDimZ);
-            sizeSi *= G4UIcommand::ValueOf(SiSizeDim);
+            is >> grid >> LiqHe >> Si >> gap;
 
-            G4ThreeVector pos(posX, posY, posZ);
-            pos *= G4UIcommand::ValueOf(GridPosDim);
-
-            G4ThreeVector rot(rotX, rotY, rotZ);
-
-            fDetector->SetSisfe(SisfeGeometryDefinition{name, nLiqHe, sizeLiqHe, sizeSi, pos, rot, mother, true});
+            fDetector->SetSisfeMaterials(grid, LiqHe, Si, gap);
         } else if (command == fColorSisfeDefCmd){
-            G4String containerCol, LiqHeCol, SiCol;
+            G4String containerCol, LiqHeCol, SiCol, grid;
             std::istringstream is(newValue);
 
-            is >> containerCol >> LiqHeCol >> SiCol;
+            is >> containerCol >> LiqHeCol >> SiCol >> grid;
 
-            fDetector->SetSisfeColour(SisfeColDefinition{containerCol, LiqHeCol, SiCol, true});
+            fDetector->SetSisfeColour(SisfeColDefinition{containerCol, LiqHeCol, SiCol, true}, grid);
 
         } else if (command == fUpdateCmd) {
             fDetector->UpdateGeometry();
+        } else if (command == fProfileCmd) {
+            fDetector->SetProfiling(G4UIcmdWithABool::GetNewBoolValue(newValue));
+        } else if (command == fOverlapModeCmd) {
+            fDetector->SetOverlapMode(newValue);
+        } else if (command == fOverlapSamplesCmd) {
+            fDetector->SetOverlapSamples(G4UIcmdWithAnInteger::GetNewIntValue(newValue));
+        } else if (command == fOverlapThreadsCmd) {
+            fDetector->SetOverlapThreads(G4UIcmdWithAnInteger::GetNewIntValue(newValue));
+        } else if (command == fOverlapCacheCmd) {
+            fDetector->SetOverlapCache(newValue);
+        } else if (command == fCompileCmd) {
+            G4String macroFile, fileName;
+            std::istringstream is(newValue);
+            is >> macroFile >> fileName;
+
+            GeometryDescription::Compile(macroFile, fileName);
+        } else if (command == fLoadCmd) {
+            GeometryDescription::Load(newValue, fDetector);
+        } else if (command == fImportCmd) {
+            fDetector->ImportShapes(newValue);
+        } else if (command == fGeometryCacheCmd) {
+            fDetector->SetCacheDirectory(newValue);
+        } else if (command == fMaterialElementCmd) {
+            fDetector->DefineMaterial(MaterialRegistry::Parse("element", newValue));
+        } else if (command == fMaterialSimpleCmd) {
+            fDetector->DefineMaterial(MaterialRegistry::Parse("simple", newValue));
+        } else if (command == fMaterialCompoundCmd) {
+            fDetector->DefineMaterial(MaterialRegistry::Parse("compound", newValue));
+        } else if (command == fMaterialMixtureCmd) {
+            fDetector->DefineMaterial(MaterialRegistry::Parse("mixture", newValue));
+        } else if (command == fMaterialLoadCmd) {
+            fDetector->LoadMaterials(newValue);
+        } else if (command == fMaterialListCmd) {
+            fDetector->ListMaterials();
+        } else if (command == fRegionAddCmd) {
+            G4String region, volume;
+            std::istringstream is(newValue);
+            is >> region >> volume;
+
+            fDetector->SetRegionVolume(region, volume);
+        } else if (command == fRegionStepCmd) {
+            G4String region, unit;
+            G4double step;
+            std::istringstream is(newValue);
+            is >> region >> step >> unit;
+
+            fDetector->SetRegionStep(region, step * G4UIcommand::ValueOf(unit));
+        } else if (command == fRegionCutCmd) {
+            G4String region, unit;
+            G4double cut;
+            std::istringstream is(newValue);
+            is >> region >> cut >> unit;
+
+            fDetector->SetRegionCut(region, cut * G4UIcommand::ValueOf(unit));
+        } else if (command == fRegionSisfeCmd) {
+            G4String grid, region;
+            std::istringstream is(newValue);
+            is >> grid >> region;
+
+            fDetector->SetSisfeRegion(grid, region.empty() ? grid : region);
+        } else if (command == fStoppingVolumeCmd) {
+            fDetector->AddStoppingVolume(newValue);
+        } else if (command == fStoppingSisfeCmd) {
+            G4String grid;
+            G4int nX, nY, nZ;
+            std::istringstream is(newValue);
+            is >> grid >> nX >> nY >> nZ;
+
+            fDetector->SetStoppingSisfe(grid, nX, nY, nZ);
+        } else if (command == fStoppingPrintCmd) {
+            StoppingScorer::Print();
+        } else if (command == fStoppingWriteCmd) {
+            StoppingScorer::Write(newValue);
+        } else if (command == fStoppingResetCmd) {
+            StoppingScorer::Reset();
+        } else if (command == fScanParameterCmd) {
+            GeoScanParameter parameter;
+            std::istringstream is(newValue);
+            is >> parameter.kind >> parameter.name >> parameter.field >> parameter.from >> parameter.to
+               >> parameter.step >> parameter.unit;
+
+            fScan->SetParameter(parameter);
+        } else if (command == fScanEventsCmd) {
+            fScan->SetEvents(G4UIcmdWithAnInteger::GetNewIntValue(newValue));
+        } else if (command == fScanOutputCmd) {
+            fScan->SetOutput(newValue);
+        } else if (command == fScanOutputCommandCmd) {
+            fScan->SetOutputCommand(newValue);
+        } else if (command == fScanRunCmd) {
+            fScan->Run();
         }
 
     }
@@ -0,0 +1,63 @@
+#include "musigGeometryArena.h"
+
+#include <G4SystemOfUnits.hh>
+
+#include <iterator>
+
+
+namespace MuSiG {
+
+
+    GeometryArena::~GeometryArena() {
+        Clear();
+    }
+
+
+    G4RotationMatrix *GeometryArena::MakeRotation(const G4ThreeVector &anglesDeg) {
+        G4RotationMatrix *rot = nullptr;
+        if (fFreeRotations.empty()) {
+            fRotations.emplace_back();
+            rot = &fRotations.back();
+        } else {
+            rot = fFreeRotations.back();
+            fFreeRotations.pop_back();
+            *rot = G4RotationMatrix();
+        }
+        fRotationsInUse.insert(rot);
+        rot->rotateX(anglesDeg.x() * deg);
+        rot->rotateY(anglesDeg.y() * deg);
+        rot->rotateZ(anglesDeg.z() * deg);
+        return rot;
+    }
+
+
+    void GeometryArena::Release(const void *object) {
+        for (auto owned = fObjects.rbegin(); owned != fObjects.rend(); ++owned) {
+            if (owned->first == object) {
+                owned->second(owned->first);
+                fObjects.erase(std::next(owned).base());
+                return;
+            }
+        }
+    }
+
+
+    void GeometryArena::ReleaseRotation(G4RotationMatrix *rot) {
+        if (fRotationsInUse.erase(rot)) {
+            fFreeRotations.push_back(rot);
+        }
+    }
+
+
+    void GeometryArena::Clear() {
+        for (auto object = fObjects.rbegin(); object != fObjects.rend(); ++object) {
+            object->second(object->first);
+        }
+        fObjects.clear();
+        fRotationsInUse.clear();
+        fFreeRotations.clear();
+        fRotations.clear();
+    }
+
+
+}
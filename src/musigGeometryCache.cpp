@@ -0,0 +1,87 @@
+#include "musigGeometryCache.h"
+
+#include <G4ios.hh>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#if __has_include(<G4GDMLParser.hh>)
+#include <G4GDMLParser.hh>
+#define MUSIG_WITH_GDML
+#endif
+
+
+namespace MuSiG {
+
+
+    G4bool GeometryCache::IsAvailable() {
+#ifdef MUSIG_WITH_GDML
+        return true;
+#else
+        return false;
+#endif
+    }
+
+
+    G4String GeometryCache::FileName(const G4String &directory, const G4String &digest) {
+        G4String name = directory;
+        if (!name.empty() && name.back() != '/') {
+            name += "/";
+        }
+        return name + "musig_geometry_" + digest + ".gdml";
+    }
+
+
+    G4bool GeometryCache::Exists(const G4String &fileName) {
+        return std::ifstream(fileName).good();
+    }
+
+
+    G4VPhysicalVolume *GeometryCache::Load(const G4String &fileName) {
+#ifdef MUSIG_WITH_GDML
+        G4GDMLParser parser;
+        parser.Read(fileName, false);
+        auto world = parser.GetWorldVolume();
+        if (world) {
+            G4cout << ">>>>>>>>>> Geometry loaded from cache " << fileName << G4endl;
+        }
+        return world;
+#else
+        G4cout << "<><><><><> WARNING: no GDML support, geometry cache " << fileName << " not read" << G4endl;
+        return nullptr;
+#endif
+    }
+
+
+    void GeometryCache::Store(const G4String &fileName, G4VPhysicalVolume *world) {
+#ifdef MUSIG_WITH_GDML
+        std::ostringstream tmpName;
+        tmpName << fileName << ".tmp";
+#if defined(__unix__) || defined(__APPLE__)
+        tmpName << getpid();
+#endif
+
+        std::remove(tmpName.str().c_str());
+
+        G4GDMLParser parser;
+        parser.Write(tmpName.str(), world);
+
+        if (std::rename(tmpName.str().c_str(), fileName.c_str()) != 0) {
+            G4cout << "<><><><><> WARNING: geometry cache " << fileName << " could not be written" << G4endl;
+            std::remove(tmpName.str().c_str());
+            return;
+        }
+        G4cout << ">>>>>>>>>> Geometry stored in cache " << fileName << G4endl;
+#else
+        G4cout << "<><><><><> WARNING: no GDML support, geometry cache " << fileName << " not written" << G4endl;
+        (void) world;
+#endif
+    }
+
+
+}
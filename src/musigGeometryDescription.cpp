@@ -0,0 +1,445 @@
+#include "musigGeometryDescription.h"
+
+#include <G4UIcommand.hh>
+#include <G4UIcommandTree.hh>
+#include <G4UImanager.hh>
+#include <G4UIparameter.hh>
+#include <G4ios.hh>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+
+namespace MuSiG {
+
+
+    namespace {
+
+        const char kMagic[4] = {'M', 'S', 'G', 'D'};
+        const std::uint32_t kVersion = 1;
+
+        // depth of nested /control/execute, guards against a macro calling itself
+        const G4int kMaxMacroDepth = 16;
+
+        enum class RecordType : std::uint8_t {
+            Box = 1,
+            Tubs,
+            Replica,
+            Sisfe,
+            SisfeLattice,
+            Command
+        };
+
+        void DescriptionError(const G4String &what) {
+            G4cout << "<><><><><> ERROR: geometry description: " << what << G4endl;
+            exit(1);
+        }
+
+        class RecordWriter {
+        public:
+            template<typename T>
+            void Put(const T &value) {
+                fData.append(reinterpret_cast<const char *>(&value), sizeof(T));
+            }
+
+            void Put(const G4String &value) {
+                Put(std::uint32_t(value.size()));
+                fData.append(value);
+            }
+
+            void Put(const G4ThreeVector &value) {
+                Put(value.x());
+                Put(value.y());
+                Put(value.z());
+            }
+
+            void Put(RecordType type) {
+                Put(static_cast<std::uint8_t>(type));
+            }
+
+            const std::string &Data() const { return fData; }
+
+        private:
+            std::string fData;
+        };
+
+        class RecordReader {
+        public:
+            RecordReader(const char *begin, const char *end) : fPos(begin), fEnd(end) {}
+
+            G4bool AtEnd() const { return fPos == fEnd; }
+
+            template<typename T>
+            T Get() {
+                Need(sizeof(T));
+                T value;
+                std::memcpy(&value, fPos, sizeof(T));
+                fPos += sizeof(T);
+                return value;
+            }
+
+            G4String GetString() {
+                const auto size = Get<std::uint32_t>();
+                Need(size);
+                G4String value(fPos, size);
+                fPos += size;
+                return value;
+            }
+
+            G4ThreeVector GetVector() {
+                const auto x = Get<G4double>();
+                const auto y = Get<G4double>();
+                const auto z = Get<G4double>();
+                return G4ThreeVector(x, y, z);
+            }
+
+        private:
+            void Need(std::size_t size) {
+                if (std::size_t(fEnd - fPos) < size) {
+                    DescriptionError("truncated file");
+                }
+            }
+
+            const char *fPos;
+            const char *fEnd;
+        };
+
+        void CompileMacro(const G4String &macroFile, RecordWriter &writer, G4int depth, G4int &nRecords,
+                          G4int &nCommands) {
+            if (depth > kMaxMacroDepth) {
+                DescriptionError("macros nested too deep at " + macroFile);
+            }
+            std::ifstream file(macroFile);
+            if (!file) {
+                DescriptionError("macro file " + macroFile + " cannot be read");
+            }
+
+            auto tree = G4UImanager::GetUIpointer()->GetTree();
+            std::string line;
+            G4int lineNumber = 0;
+            while (std::getline(file, line)) {
+                ++lineNumber;
+                const auto where = " (" + macroFile + " line " + std::to_string(lineNumber) + ")";
+
+                const auto first = line.find_first_not_of(" \t\r");
+                if ((first == std::string::npos) || (line[first] == '#')) {
+                    continue;
+                }
+                line = line.substr(first, line.find_last_not_of(" \t\r") - first + 1);
+                if (line.find('{') != std::string::npos) {
+                    DescriptionError("aliases are not resolved at compile time" + where);
+                }
+
+                const auto split = line.find_first_of(" \t");
+                const G4String path = line.substr(0, split);
+                G4String args;
+                if (split != std::string::npos) {
+                    args = line.substr(line.find_first_not_of(" \t", split));
+                }
+
+                if (path == "/control/execute") {
+                    CompileMacro(args, writer, depth + 1, nRecords, nCommands);
+                    continue;
+                }
+
+                auto command = tree->FindPath(path);
+                if (!command) {
+                    DescriptionError("unknown command " + path + where);
+                }
+
+                // omitted parameters get their default value, as G4UIcommand::DoIt does
+                std::istringstream is(args);
+                std::size_t nTokens = 0;
+                for (std::string token; is >> token;) {
+                    ++nTokens;
+                }
+                for (auto i = nTokens; i < std::size_t(command->GetParameterEntries()); ++i) {
+                    auto parameter = command->GetParameter(G4int(i));
+                    if (!parameter->IsOmittable()) {
+                        DescriptionError("parameter " + parameter->GetParameterName() + " of " + path + " missing" +
+                                         where);
+                    }
+                    args += " " + parameter->GetDefaultValue();
+                }
+
+                if ((path == "/setup/box") || (path == "/setup/tubs")) {
+                    const auto def = GeometryDescription::ParseShape(args);
+                    writer.Put((path == "/setup/box") ? RecordType::Box : RecordType::Tubs);
+                    writer.Put(def.name);
+                    writer.Put(def.mat);
+                    writer.Put(def.size);
+                    writer.Put(def.pos);
+                    writer.Put(def.rot);
+                    writer.Put(def.mother);
+                    writer.Put(def.booltype);
+                } else if (path == "/setup/replica") {
+                    const auto rep = GeometryDescription::ParseReplica(args);
+                    writer.Put(RecordType::Replica);
+                    writer.Put(rep.name);
+                    writer.Put(std::int32_t(rep.num));
+                    writer.Put(rep.type);
+                    writer.Put(rep.shift);
+                } else if (path == "/setup/sisfe") {
+                    const auto grid = GeometryDescription::ParseSisfe(args);
+                    writer.Put(RecordType::Sisfe);
+                    writer.Put(grid.name);
+                    writer.Put(std::int32_t(grid.nLiqHe));
+                    writer.Put(grid.sizeLiqHe);
+                    writer.Put(grid.sizeSi);
+                    writer.Put(grid.pos);
+                    writer.Put(grid.rot);
+                    writer.Put(grid.mother);
+                    writer.Put(grid.placement);
+                } else if (path == "/setup/sisfeLattice") {
+                    const auto lattice = GeometryDescription::ParseSisfeLattice(args);
+                    writer.Put(RecordType::SisfeLattice);
+                    writer.Put(lattice.name);
+                    writer.Put(std::int32_t(lattice.nX));
+                    writer.Put(std::int32_t(lattice.nY));
+                    writer.Put(std::int32_t(lattice.nLayers));
+                    writer.Put(lattice.pitch);
+                    writer.Put(lattice.cell);
+                    writer.Put(lattice.fill);
+                } else {
+                    writer.Put(RecordType::Command);
+                    writer.Put(path + " " + args);
+                    ++nCommands;
+                }
+                ++nRecords;
+            }
+        }
+
+    }
+
+
+    DetBoxTubsDefinition GeometryDescription::ParseShape(const G4String &args) {
+        G4String nam;
+        G4String mat;
+        G4double v1, v2, v3;
+        G4String unt_size;
+        G4double p1, p2, p3;
+        G4String unt_pos;
+        G4double d1, d2, d3;
+        G4String mother;
+        G4String isbool;
+
+        std::istringstream is(args);
+
+        is >> nam >> mat >> v1 >> v2 >> v3 >> unt_size >> p1 >> p2 >> p3 >> unt_pos >> d1 >> d2 >> d3 >> mother
+           >> isbool;
+
+        G4ThreeVector vec1(v1, v2, v3);
+        vec1 *= G4UIcommand::ValueOf(unt_size);
+
+        G4ThreeVector vec2(p1, p2, p3);
+        vec2 *= G4UIcommand::ValueOf(unt_pos);
+
+        G4ThreeVector vec3(d1, d2, d3);
+
+        return DetBoxTubsDefinition{nam, mat, vec1, vec2, vec3, mother, isbool};
+    }
+
+
+    DetReplica GeometryDescription::ParseReplica(const G4String &args) {
+        G4String nam;
+        G4String typ;
+        G4double v1, v2, v3;
+        G4int num;
+        G4String unt_pos;
+
+        std::istringstream is(args);
+
+        is >> nam >> num >> typ >> v1 >> v2 >> v3 >> unt_pos;
+
+        G4ThreeVector vec1(v1, v2, v3);
+        vec1 *= G4UIcommand::ValueOf(unt_pos);
+
+        return DetReplica{nam, num, typ, vec1};
+    }
+
+
+    SisfeGeometryDefinition GeometryDescription::ParseSisfe(const G4String &args) {
+        G4String name;
+        G4int nLiqHe;
+        G4double LiqHeDimX, LiqHeDimY, LiqHeDimZ;
+        G4String LiqHeSizeDim;
+        G4double SiDimX, SiDimY, SiDimZ;
+        G4String SiSizeDim;
+        G4double posX, posY, posZ;
+        G4String GridPosDim;
+        G4double rotX, rotY, rotZ;
+        G4String mother;
+        G4String placement;
+
+        std::istringstream is(args);
+        is >> name >> nLiqHe >> LiqHeDimX >> LiqHeDimY >> LiqHeDimZ >> LiqHeSizeDim >> SiDimX >> SiDimY >> SiDimZ >> SiSizeDim >> posX >> posY >> posZ >> GridPosDim >> rotX >> rotY >> rotZ >> mother >> placement;
+
+        G4ThreeVector sizeLiqHe(LiqHeDimX, LiqHeDimY, LiqHeDimZ);
+        sizeLiqHe *= G4UIcommand::ValueOf(LiqHeSizeDim);
+
+        G4ThreeVector sizeSi(SiDimX, SiDimY, SiDimZ);
+        sizeSi *= G4UIcommand::ValueOf(SiSizeDim);
+
+        G4ThreeVector pos(posX, posY, posZ);
+        pos *= G4UIcommand::ValueOf(GridPosDim);
+
+        SisfeGeometryDefinition grid;
+        grid.name = name;
+        grid.nLiqHe = nLiqHe;
+        grid.sizeLiqHe = sizeLiqHe;
+        grid.sizeSi = sizeSi;
+        grid.pos = pos;
+        grid.rot = G4ThreeVector(rotX, rotY, rotZ);
+        grid.mother = mother;
+        grid.isPlaced = true;
+        grid.placement = placement;
+        return grid;
+    }
+
+
+    SisfeLatticeDefinition GeometryDescription::ParseSisfeLattice(const G4String &args) {
+        G4String name;
+        G4int nX, nY, nLayers;
+        G4double pitchX, pitchY;
+        G4String pitchDim;
+        G4String cell;
+        G4String fill;
+
+        std::istringstream is(args);
+        is >> name >> nX >> nY >> nLayers >> pitchX >> pitchY >> pitchDim >> cell >> fill;
+
+        G4ThreeVector pitch(pitchX, pitchY, 0.);
+        pitch *= G4UIcommand::ValueOf(pitchDim);
+
+        if (fill == "LiqHe") {
+            fill = "";
+        }
+
+        return SisfeLatticeDefinition{name, nX, nY, nLayers, pitch, cell, fill};
+    }
+
+
+    void GeometryDescription::Compile(const G4String &macroFile, const G4String &fileName) {
+        RecordWriter writer;
+        G4int nRecords = 0;
+        G4int nCommands = 0;
+        CompileMacro(macroFile, writer, 0, nRecords, nCommands);
+
+        std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            DescriptionError("file " + fileName + " cannot be written");
+        }
+        file.write(kMagic, sizeof(kMagic));
+        file.write(reinterpret_cast<const char *>(&kVersion), sizeof(kVersion));
+        file.write(writer.Data().data(), std::streamsize(writer.Data().size()));
+        if (!file) {
+            DescriptionError("file " + fileName + " cannot be written");
+        }
+
+        G4cout << ">>>>>>>>>> geometry description " << fileName << ": " << (nRecords - nCommands)
+               << " definitions and " << nCommands << " commands compiled from " << macroFile << G4endl;
+    }
+
+
+    void GeometryDescription::Load(const G4String &fileName, DetectorConstruction *detector) {
+        // the whole file is read at once and decoded in memory
+        std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+        if (!file) {
+            DescriptionError("file " + fileName + " cannot be read");
+        }
+        std::string data(std::size_t(file.tellg()), '\0');
+        file.seekg(0);
+        file.read(&data[0], std::streamsize(data.size()));
+        if (!file) {
+            DescriptionError("file " + fileName + " cannot be read");
+        }
+
+        RecordReader reader(data.data(), data.data() + data.size());
+        char magic[sizeof(kMagic)];
+        for (auto &c: magic) {
+            c = reader.Get<char>();
+        }
+        if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+            DescriptionError(fileName + " is not a compiled geometry description");
+        }
+        if (reader.Get<std::uint32_t>() != kVersion) {
+            DescriptionError(fileName + " has an unsupported version, compile the macro again");
+        }
+
+        G4int nRecords = 0;
+        while (!reader.AtEnd()) {
+            const auto type = static_cast<RecordType>(reader.Get<std::uint8_t>());
+            switch (type) {
+                case RecordType::Box:
+                case RecordType::Tubs: {
+                    DetBoxTubsDefinition def;
+                    def.name = reader.GetString();
+                    def.mat = reader.GetString();
+                    def.size = reader.GetVector();
+                    def.pos = reader.GetVector();
+                    def.rot = reader.GetVector();
+                    def.mother = reader.GetString();
+                    def.booltype = reader.GetString();
+                    if (type == RecordType::Box) {
+                        detector->SetBoxDefinition(def);
+                    } else {
+                        detector->SetTubsDefinition(def);
+                    }
+                    break;
+                }
+                case RecordType::Replica: {
+                    DetReplica rep;
+                    rep.name = reader.GetString();
+                    rep.num = reader.Get<std::int32_t>();
+                    rep.type = reader.GetString();
+                    rep.shift = reader.GetVector();
+                    detector->SetRepDefinition(rep);
+                    break;
+                }
+                case RecordType::Sisfe: {
+                    SisfeGeometryDefinition grid;
+                    grid.name = reader.GetString();
+                    grid.nLiqHe = reader.Get<std::int32_t>();
+                    grid.sizeLiqHe = reader.GetVector();
+                    grid.sizeSi = reader.GetVector();
+                    grid.pos = reader.GetVector();
+                    grid.rot = reader.GetVector();
+                    grid.mother = reader.GetString();
+                    grid.placement = reader.GetString();
+                    grid.isPlaced = true;
+                    detector->SetSisfe(grid);
+                    break;
+                }
+                case RecordType::SisfeLattice: {
+                    SisfeLatticeDefinition lattice;
+                    lattice.name = reader.GetString();
+                    lattice.nX = reader.Get<std::int32_t>();
+                    lattice.nY = reader.Get<std::int32_t>();
+                    lattice.nLayers = reader.Get<std::int32_t>();
+                    lattice.pitch = reader.GetVector();
+                    lattice.cell = reader.GetString();
+                    lattice.fill = reader.GetString();
+                    detector->SetSisfeLattice(lattice);
+                    break;
+                }
+                case RecordType::Command: {
+                    const auto command = reader.GetString();
+                    if (G4UImanager::GetUIpointer()->ApplyCommand(command) != fCommandSucceeded) {
+                        DescriptionError("command failed: " + command);
+                    }
+                    break;
+                }
+                default:
+                    DescriptionError(fileName + " has an unknown record type");
+            }
+            ++nRecords;
+        }
+
+        G4cout << ">>>>>>>>>> geometry description " << fileName << ": " << nRecords << " records loaded" << G4endl;
+    }
+
+
+}
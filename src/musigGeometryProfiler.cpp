@@ -0,0 +1,116 @@
+#include "musigGeometryProfiler.h"
+
+#include <G4SolidStore.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4PhysicalVolumeStore.hh>
+#include <G4ios.hh>
+
+#include <fstream>
+#include <iomanip>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+
+namespace MuSiG {
+
+
+    void GeometryProfiler::Reset() {
+        fPhases.clear();
+        fOpen = false;
+    }
+
+
+    void GeometryProfiler::BeginPhase(const G4String &name) {
+        if (!fEnabled) {
+            return;
+        }
+        if (fOpen) {
+            EndPhase();
+        }
+
+        fCurrent = GeoPhaseRecord{name};
+        fSolids0 = G4long(G4SolidStore::GetInstance()->size());
+        fLogical0 = G4long(G4LogicalVolumeStore::GetInstance()->size());
+        fPhysical0 = G4long(G4PhysicalVolumeStore::GetInstance()->size());
+        fRss0 = ResidentMemory();
+        fOpen = true;
+        fStart = std::chrono::steady_clock::now();
+    }
+
+
+    void GeometryProfiler::EndPhase() {
+        if (!fEnabled || !fOpen) {
+            return;
+        }
+
+        const auto stop = std::chrono::steady_clock::now();
+        fCurrent.time = std::chrono::duration<G4double, std::milli>(stop - fStart).count();
+        fCurrent.nSolids = G4long(G4SolidStore::GetInstance()->size()) - fSolids0;
+        fCurrent.nLogical = G4long(G4LogicalVolumeStore::GetInstance()->size()) - fLogical0;
+        fCurrent.nPhysical = G4long(G4PhysicalVolumeStore::GetInstance()->size()) - fPhysical0;
+
+        const auto rss = ResidentMemory();
+        fCurrent.rssDelta = (rss >= 0 && fRss0 >= 0) ? (rss - fRss0) : 0;
+
+        fPhases.push_back(fCurrent);
+        fOpen = false;
+    }
+
+
+    void GeometryProfiler::PrintSummary() const {
+        if (!fEnabled) {
+            return;
+        }
+
+        GeoPhaseRecord total{"total"};
+        for (const auto &phase: fPhases) {
+            total.time += phase.time;
+            total.nSolids += phase.nSolids;
+            total.nLogical += phase.nLogical;
+            total.nPhysical += phase.nPhysical;
+            total.rssDelta += phase.rssDelta;
+        }
+
+        auto printRow = [](const GeoPhaseRecord &row) {
+            G4cout << std::left << std::setw(22) << row.name << std::right
+                   << std::setw(12) << std::fixed << std::setprecision(3) << row.time
+                   << std::setw(10) << row.nSolids
+                   << std::setw(10) << row.nLogical
+                   << std::setw(10) << row.nPhysical
+                   << std::setw(12) << row.rssDelta << G4endl;
+        };
+
+        G4cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  " << G4endl;
+        G4cout << "GEOMETRY CONSTRUCTION PROFILE" << G4endl;
+        G4cout << std::left << std::setw(22) << "phase" << std::right
+               << std::setw(12) << "time [ms]"
+               << std::setw(10) << "solids"
+               << std::setw(10) << "logical"
+               << std::setw(10) << "physical"
+               << std::setw(12) << "RSS [kB]" << G4endl;
+        for (const auto &phase: fPhases) {
+            printRow(phase);
+        }
+        printRow(total);
+        G4cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>  " << G4endl;
+        G4cout << std::defaultfloat;
+    }
+
+
+    G4long GeometryProfiler::ResidentMemory() {
+#if defined(__linux__)
+        // second field of statm is the number of resident pages
+        std::ifstream statm("/proc/self/statm");
+        G4long size = 0;
+        G4long resident = 0;
+        if (statm >> size >> resident) {
+            return resident * (sysconf(_SC_PAGESIZE) / 1024);
+        }
+#endif
+        return -1;
+    }
+
+
+}
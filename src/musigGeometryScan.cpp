@@ -0,0 +1,256 @@
+#include "musigGeometryScan.h"
+#include "musigDetectorConstruction.h"
+
+#include <G4RunManager.hh>
+#include <G4StateManager.hh>
+#include <G4Threading.hh>
+#include <G4UImanager.hh>
+#include <G4UIcommand.hh>
+#include <G4ios.hh>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+
+namespace MuSiG {
+
+
+    namespace {
+
+        // a mistyped command or a value out of range would otherwise run every point with the parameter unchanged
+        void ApplyScanCommand(const G4String &command) {
+            if (G4UImanager::GetUIpointer()->ApplyCommand(command) != fCommandSucceeded) {
+                G4cout << "<><><><><> ERROR: scan command failed: " << command << G4endl;
+                exit(1);
+            }
+        }
+
+        // component x, y or z of a field named like "sizeSi.z"
+        G4bool SetComponent(G4ThreeVector &vec, const G4String &field, G4double value) {
+            const auto dot = field.rfind('.');
+            if (dot == std::string::npos || dot + 2 != field.size()) {
+                return false;
+            }
+            switch (field[dot + 1]) {
+                case 'x':
+                    vec.setX(value);
+                    return true;
+                case 'y':
+                    vec.setY(value);
+                    return true;
+                case 'z':
+                    vec.setZ(value);
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        G4String FieldBase(const G4String &field) {
+            return G4String(field.substr(0, field.rfind('.')));
+        }
+
+    }
+
+
+    G4bool GeometryScan::IsValidField(const G4String &kind, const G4String &field) {
+        if (kind == "ui") {
+            return true;
+        }
+
+        G4ThreeVector probe;
+        const auto base = FieldBase(field);
+        if (kind == "sisfe") {
+            return (field == "nLiqHe") ||
+                   (((base == "sizeLiqHe") || (base == "sizeSi") || (base == "pos") || (base == "rot")) &&
+                    SetComponent(probe, field, 0.));
+        }
+        if ((kind == "box") || (kind == "tubs")) {
+            return ((base == "size") || (base == "pos") || (base == "rot")) && SetComponent(probe, field, 0.);
+        }
+        return false;
+    }
+
+
+    G4bool GeometryScan::IsLength(const G4String &field) {
+        return (field != "nLiqHe") && (FieldBase(field) != "rot");
+    }
+
+
+    void GeometryScan::SetParameter(const GeoScanParameter &parameter) {
+        if (!IsValidField(parameter.kind, parameter.field)) {
+            G4cout << "<><><><><> ERROR: scan of " << parameter.kind << " field " << parameter.field
+                   << " is invalid, options: sisfe (nLiqHe, sizeLiqHe.x/y/z, sizeSi.x/y/z, pos.x/y/z, rot.x/y/z), "
+                   << "box/tubs (size.x/y/z, pos.x/y/z, rot.x/y/z), ui" << G4endl;
+            exit(1);
+        }
+        if ((parameter.step <= 0.) || (parameter.to < parameter.from)) {
+            G4cout << "<><><><><> ERROR: scan range " << parameter.from << " - " << parameter.to << " by "
+                   << parameter.step << " is invalid" << G4endl;
+            exit(1);
+        }
+        if ((parameter.kind != "ui") && IsLength(parameter.field) && (G4UIcommand::ValueOf(parameter.unit) <= 0.)) {
+            G4cout << "<><><><><> ERROR: scan unit " << parameter.unit << " of " << parameter.field
+                   << " is not a length unit" << G4endl;
+            exit(1);
+        }
+        if ((parameter.kind == "sisfe") && !fDetector->GetSisfe(parameter.name)) {
+            G4cout << "<><><><><> ERROR: sisfe grid named " << parameter.name << " for scan was not defined!"
+                   << G4endl;
+            exit(1);
+        }
+        if ((parameter.kind == "box") || (parameter.kind == "tubs")) {
+            auto def = fDetector->GetShapeDefinition(parameter.name);
+            if (!def) {
+                G4cout << "<><><><><> ERROR: volume named " << parameter.name << " for scan was not defined!"
+                       << G4endl;
+                exit(1);
+            }
+            // a boolean definition is added again, not replaced, when it is set again: only A volumes are scanned
+            if (def->params.booltype != "A") {
+                G4cout << "<><><><><> ERROR: volume named " << parameter.name << " for scan is a boolean ("
+                       << def->params.booltype << "), only volumes with booltype A can be scanned" << G4endl;
+                exit(1);
+            }
+        }
+
+        fParameter = parameter;
+        fHasParameter = true;
+    }
+
+
+    void GeometryScan::Apply(G4double value) {
+        const auto &kind = fParameter.kind;
+        const auto &field = fParameter.field;
+
+        if (kind == "ui") {
+            std::ostringstream command;
+            command << fParameter.name << " " << value;
+            if (fParameter.unit != "-") {
+                command << " " << fParameter.unit;
+            }
+            ApplyScanCommand(command.str());
+            return;
+        }
+
+        const auto internal = IsLength(field) ? value * G4UIcommand::ValueOf(fParameter.unit) : value;
+
+        if (kind == "sisfe") {
+            auto grid = *fDetector->GetSisfe(fParameter.name);
+            if (field == "nLiqHe") {
+                grid.nLiqHe = G4int(std::lround(value));
+            } else {
+                const auto base = FieldBase(field);
+                auto &vec = (base == "sizeLiqHe") ? grid.sizeLiqHe : (base == "sizeSi") ? grid.sizeSi :
+                                                                     (base == "pos") ? grid.pos : grid.rot;
+                SetComponent(vec, field, internal);
+            }
+            fDetector->SetSisfe(grid);
+        } else {
+            const auto def = *fDetector->GetShapeDefinition(fParameter.name);
+            auto params = def.params;
+            const auto base = FieldBase(field);
+            auto &vec = (base == "size") ? params.size : (base == "pos") ? params.pos : params.rot;
+            SetComponent(vec, field, internal);
+            if (def.shape == "tubs") {
+                fDetector->SetTubsDefinition(params);
+            } else {
+                fDetector->SetBoxDefinition(params);
+            }
+        }
+
+        fDetector->UpdateGeometry();
+        // under MT the update only marks the geometry for a rebuild at the next run: the master builds it here, so
+        // that it is timed as build and not as run; the workers take the new world up when the run starts
+        if (G4Threading::IsMultithreadedApplication()) {
+            G4RunManager::GetRunManager()->InitializeGeometry();
+        }
+    }
+
+
+    void GeometryScan::Run() {
+        using clock = std::chrono::steady_clock;
+
+        if (!fHasParameter) {
+            G4cout << "<><><><><> ERROR: no /setup/scan/parameter set for the scan" << G4endl;
+            exit(1);
+        }
+        if (G4StateManager::GetStateManager()->GetCurrentState() != G4State_Idle) {
+            G4cout << "<><><><><> ERROR: /setup/scan/run needs an initialised run manager (/run/initialize)"
+                   << G4endl;
+            exit(1);
+        }
+
+        // the definition is restored after the scan
+        const auto isSisfe = (fParameter.kind == "sisfe");
+        const auto isShape = (fParameter.kind == "box") || (fParameter.kind == "tubs");
+        SisfeGeometryDefinition savedGrid;
+        DetShapeDefinition savedShape;
+        if (isSisfe) {
+            savedGrid = *fDetector->GetSisfe(fParameter.name);
+        } else if (isShape) {
+            savedShape = *fDetector->GetShapeDefinition(fParameter.name);
+        }
+
+        const auto nPoints = G4int(std::floor((fParameter.to - fParameter.from) / fParameter.step + 1e-9)) + 1;
+        fPoints.clear();
+
+        for (G4int i = 0; i < nPoints; ++i) {
+            GeoScanPoint point;
+            point.index = i;
+            point.value = fParameter.from + i * fParameter.step;
+
+            G4cout << ">>>>>>>>>> scan point " << i << " / " << nPoints << " : " << fParameter.kind << " "
+                   << fParameter.name << " " << fParameter.field << " = " << point.value << " " << fParameter.unit
+                   << G4endl;
+
+            auto start = clock::now();
+            Apply(point.value);
+            point.buildTime = std::chrono::duration<G4double, std::milli>(clock::now() - start).count();
+
+            if (!fOutputPrefix.empty()) {
+                std::ostringstream command;
+                command << fOutputCommand << " " << fOutputPrefix << "_" << i;
+                ApplyScanCommand(command.str());
+            }
+
+            start = clock::now();
+            if (fEvents > 0) {
+                G4RunManager::GetRunManager()->BeamOn(fEvents);
+            }
+            point.runTime = std::chrono::duration<G4double, std::milli>(clock::now() - start).count();
+
+            fPoints.push_back(point);
+        }
+
+        if (isSisfe) {
+            fDetector->SetSisfe(savedGrid);
+            fDetector->UpdateGeometry();
+        } else if (isShape) {
+            if (savedShape.shape == "tubs") {
+                fDetector->SetTubsDefinition(savedShape.params);
+            } else {
+                fDetector->SetBoxDefinition(savedShape.params);
+            }
+            fDetector->UpdateGeometry();
+        }
+
+        G4cout << G4endl << "########## Scan of " << fParameter.kind << " " << fParameter.name << " "
+               << fParameter.field << " [" << fParameter.unit << "], " << fEvents << " events per point" << G4endl;
+        G4cout << std::setw(8) << "point" << std::setw(14) << "value" << std::setw(14) << "build [ms]"
+               << std::setw(14) << "run [ms]" << G4endl;
+        if (G4Threading::IsMultithreadedApplication()) {
+            G4cout << "(MT: build is the geometry of the master, the worker threads rebuild theirs within run)"
+                   << G4endl;
+        }
+        for (const auto &point: fPoints) {
+            G4cout << std::setw(8) << point.index << std::setw(14) << point.value << std::setw(14) << std::fixed
+                   << std::setprecision(2) << point.buildTime << std::setw(14) << point.runTime << G4endl;
+        }
+        G4cout << std::defaultfloat;
+    }
+
+
+}
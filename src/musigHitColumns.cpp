@@ -0,0 +1,253 @@
+#include "musigHitColumns.h"
+
+#include <G4SystemOfUnits.hh>
+#include <G4ios.hh>
+
+#include <algorithm>
+#include <cstring>
+
+#include <zlib.h>
+
+
+namespace MuSiG {
+
+
+    namespace {
+
+        const char kMagic[4] = {'M', 'S', 'H', 'C'};
+        const std::uint32_t kVersion = 1;
+        const std::size_t kIntColumns = 3;
+
+        template<typename T>
+        void WriteValue(std::ofstream &file, const T &value) {
+            file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        G4bool ReadValue(std::ifstream &file, T &value) {
+            return static_cast<G4bool>(file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+        }
+
+        template<typename T>
+        void WriteColumn(std::ofstream &file, const std::vector<T> &column, std::vector<unsigned char> &buffer) {
+            const auto rawSize = uLong(column.size() * sizeof(T));
+            auto size = compressBound(rawSize);
+            buffer.resize(size);
+            if (compress2(buffer.data(), &size, reinterpret_cast<const Bytef *>(column.data()), rawSize,
+                          Z_BEST_SPEED) != Z_OK) {
+                G4cout << "<><><><><> ERROR: compression of a hit column failed" << G4endl;
+                exit(1);
+            }
+            WriteValue(file, std::uint64_t(size));
+            WriteValue(file, std::uint64_t(rawSize));
+            file.write(reinterpret_cast<const char *>(buffer.data()), std::streamsize(size));
+        }
+
+        void ReadError(const char *what) {
+            G4cout << "<><><><><> ERROR: hit column file: " << what << G4endl;
+            exit(1);
+        }
+
+    }
+
+
+    HitColumnWriter::~HitColumnWriter() {
+        if (IsOpen()) {
+            Close();
+        }
+    }
+
+
+    void HitColumnWriter::Open(const G4String &fileName) {
+        fFile.open(fileName, std::ios::binary | std::ios::trunc);
+        if (!fFile) {
+            G4cout << "<><><><><> ERROR: hit column file " << fileName << " cannot be written" << G4endl;
+            exit(1);
+        }
+        fFile.write(kMagic, sizeof(kMagic));
+        WriteValue(fFile, kVersion);
+        WriteValue(fFile, std::uint32_t(HitColumn::Count));
+
+        for (auto &column: fInts) {
+            column.clear();
+            column.reserve(fBlockSize);
+        }
+        for (auto &column: fDoubles) {
+            column.clear();
+            column.reserve(fBlockSize);
+        }
+        fVolumes.clear();
+        fNewVolumes.clear();
+    }
+
+
+    G4int HitColumnWriter::VolumeID(const G4String &volume) {
+        const auto found = fVolumes.find(volume);
+        if (found != fVolumes.end()) {
+            return found->second;
+        }
+        const auto id = G4int(fVolumes.size());
+        fVolumes.emplace(volume, id);
+        fNewVolumes.push_back(volume);
+        return id;
+    }
+
+
+    void HitColumnWriter::Add(const HitRecord &hit) {
+        fInts[0].push_back(hit.eventID);
+        fInts[1].push_back(VolumeID(hit.volume));
+        fInts[2].push_back(hit.copyNo);
+        fDoubles[0].push_back(hit.pos.x() / mm);
+        fDoubles[1].push_back(hit.pos.y() / mm);
+        fDoubles[2].push_back(hit.pos.z() / mm);
+        fDoubles[3].push_back(hit.edep / keV);
+        fDoubles[4].push_back(hit.time / ns);
+
+        if (fInts[0].size() >= fBlockSize) {
+            WriteBlock();
+        }
+    }
+
+
+    void HitColumnWriter::WriteBlock() {
+        const auto rows = std::uint32_t(fInts[0].size());
+        if (rows == 0) {
+            return;
+        }
+
+        WriteValue(fFile, rows);
+        WriteValue(fFile, std::uint32_t(fNewVolumes.size()));
+        for (const auto &volume: fNewVolumes) {
+            WriteValue(fFile, std::uint32_t(volume.size()));
+            fFile.write(volume.data(), std::streamsize(volume.size()));
+        }
+        fNewVolumes.clear();
+
+        std::vector<unsigned char> buffer;
+        for (auto &column: fInts) {
+            WriteColumn(fFile, column, buffer);
+            column.clear();
+        }
+        for (auto &column: fDoubles) {
+            WriteColumn(fFile, column, buffer);
+            column.clear();
+        }
+    }
+
+
+    void HitColumnWriter::Close() {
+        WriteBlock();
+        WriteValue(fFile, std::uint32_t(0));
+        fFile.close();
+    }
+
+
+    void HitColumnReader::Open(const G4String &fileName) {
+        fFile.close();
+        fFile.clear();
+        fFile.open(fileName, std::ios::binary);
+        if (!fFile) {
+            G4cout << "<><><><><> ERROR: hit column file " << fileName << " not found" << G4endl;
+            exit(1);
+        }
+
+        char magic[4];
+        std::uint32_t version = 0;
+        if (!fFile.read(magic, sizeof(magic)) || (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) ||
+            !ReadValue(fFile, version) || (version != kVersion) || !ReadValue(fFile, fColumns) ||
+            (fColumns != std::uint32_t(HitColumn::Count))) {
+            ReadError("not a hit column file of this version");
+        }
+        fRows = 0;
+        fVolumeNames.clear();
+    }
+
+
+    G4bool HitColumnReader::ReadBlock(const std::vector<HitColumn> &columns) {
+        // a complete file ends with an empty block: running out of data before it means the file is truncated
+        std::uint32_t rows = 0;
+        if (!ReadValue(fFile, rows)) {
+            ReadError("truncated file");
+        }
+        if (rows == 0) {
+            fRows = 0;
+            return false;
+        }
+        fRows = rows;
+
+        std::uint32_t nVolumes = 0;
+        if (!ReadValue(fFile, nVolumes)) {
+            ReadError("truncated block");
+        }
+        for (std::uint32_t i = 0; i < nVolumes; ++i) {
+            std::uint32_t length = 0;
+            if (!ReadValue(fFile, length)) {
+                ReadError("truncated block");
+            }
+            std::string volume(length, '\0');
+            if (!fFile.read(&volume[0], std::streamsize(length))) {
+                ReadError("truncated block");
+            }
+            fVolumeNames.emplace_back(volume);
+        }
+
+        for (std::uint32_t i = 0; i < fColumns; ++i) {
+            std::uint64_t size = 0;
+            std::uint64_t rawSize = 0;
+            if (!ReadValue(fFile, size) || !ReadValue(fFile, rawSize)) {
+                ReadError("truncated block");
+            }
+
+            const auto column = HitColumn(i);
+            auto isInt = (i < kIntColumns);
+            if (isInt) {
+                fInts[i].clear();
+            } else {
+                fDoubles[i - kIntColumns].clear();
+            }
+
+            // columns not asked for are skipped without decompressing them
+            if (std::find(columns.begin(), columns.end(), column) == columns.end()) {
+                fFile.seekg(std::streamoff(size), std::ios::cur);
+                continue;
+            }
+
+            fBuffer.resize(size);
+            fFile.read(reinterpret_cast<char *>(fBuffer.data()), std::streamsize(size));
+            void *target = nullptr;
+            if (isInt) {
+                fInts[i].resize(rawSize / sizeof(std::int32_t));
+                target = fInts[i].data();
+            } else {
+                fDoubles[i - kIntColumns].resize(rawSize / sizeof(G4double));
+                target = fDoubles[i - kIntColumns].data();
+            }
+            auto destSize = uLong(rawSize);
+            if (!fFile || (uncompress(static_cast<Bytef *>(target), &destSize, fBuffer.data(), uLong(size)) != Z_OK) ||
+                (destSize != rawSize)) {
+                ReadError("corrupted column");
+            }
+        }
+        return true;
+    }
+
+
+    const std::vector<std::int32_t> &HitColumnReader::GetInts(HitColumn column) const {
+        const auto i = std::size_t(column);
+        if (i >= kIntColumns) {
+            ReadError("column is not an integer column");
+        }
+        return fInts[i];
+    }
+
+
+    const std::vector<G4double> &HitColumnReader::GetDoubles(HitColumn column) const {
+        const auto i = std::size_t(column);
+        if ((i < kIntColumns) || (i >= std::size_t(HitColumn::Count))) {
+            ReadError("column is not a floating point column");
+        }
+        return fDoubles[i - kIntColumns];
+    }
+
+
+}
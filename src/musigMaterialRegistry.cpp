@@ -0,0 +1,253 @@
+#include "musigMaterialRegistry.h"
+
+#include <G4NistManager.hh>
+#include <G4PhysicalConstants.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4UIcommand.hh>
+#include <G4ios.hh>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+
+namespace MuSiG {
+
+
+    G4Material *MaterialRegistry::Get(const G4String &name) {
+        auto cached = fMaterials.find(name);
+        if (cached != fMaterials.end()) {
+            return cached->second;
+        }
+
+        // a material made elsewhere (e.g. read from a GDML geometry cache) is used as it is, not built again
+        auto mat = G4Material::GetMaterial(name, false);
+        if (!mat) {
+            auto factory = fFactories.find(name);
+            mat = (factory != fFactories.end()) ? factory->second()
+                                                : G4NistManager::Instance()->FindOrBuildMaterial(name);
+        }
+
+        if (mat) {
+            fMaterials[name] = mat;
+            fBuilt.push_back(mat);
+        }
+        return mat;
+    }
+
+
+    G4bool MaterialRegistry::Has(const G4String &name) const {
+        if (fMaterials.count(name) || fFactories.count(name) || G4Material::GetMaterial(name, false)) {
+            return true;
+        }
+        const auto &nist = G4NistManager::Instance()->GetNistMaterialNames();
+        return std::find(nist.begin(), nist.end(), name) != nist.end();
+    }
+
+
+    G4Element *MaterialRegistry::GetElement(const G4String &name) {
+        auto cached = fElements.find(name);
+        if (cached != fElements.end()) {
+            return cached->second;
+        }
+
+        auto factory = fElementFactories.find(name);
+        auto element = (factory != fElementFactories.end()) ? factory->second()
+                                                            : G4NistManager::Instance()->FindOrBuildElement(name);
+        if (!element) {
+            G4cout << "<><><><><> ERROR: element named " << name << " not found" << G4endl;
+            exit(1);
+        }
+        fElements[name] = element;
+        return element;
+    }
+
+
+    G4State MaterialRegistry::ParseState(const G4String &state) {
+        if (state == "solid") {
+            return kStateSolid;
+        }
+        if (state == "liquid") {
+            return kStateLiquid;
+        }
+        if (state == "gas") {
+            return kStateGas;
+        }
+        if (state == "undefined") {
+            return kStateUndefined;
+        }
+        G4cout << "<><><><><> ERROR: material state " << state << " not valid, options: solid liquid gas undefined"
+               << G4endl;
+        exit(1);
+    }
+
+
+    MaterialDefinition MaterialRegistry::Parse(const G4String &kind, const G4String &arguments) {
+        // the components may be given as one quoted UI parameter
+        G4String line = arguments;
+        line.erase(std::remove(line.begin(), line.end(), '"'), line.end());
+        std::istringstream is(line);
+
+        MaterialDefinition def;
+        def.kind = kind;
+        is >> def.name;
+
+        auto readUnit = [&is, &def](const char *what) {
+            G4String unit;
+            is >> unit;
+            const auto value = G4UIcommand::ValueOf(unit);
+            if (value <= 0.) {
+                G4cout << "<><><><><> ERROR: " << what << " unit " << unit << " of material " << def.name
+                       << " not valid" << G4endl;
+                exit(1);
+            }
+            return value;
+        };
+
+        // density unit state temperature[K] pressure unit, the state and the conditions are optional for simple
+        auto readConditions = [&is, &def, &readUnit](G4bool optional) {
+            is >> def.density;
+            def.density *= readUnit("density");
+            G4String state;
+            if (!(is >> state)) {
+                if (optional) {
+                    return;
+                }
+                G4cout << "<><><><><> ERROR: missing state of material " << def.name << G4endl;
+                exit(1);
+            }
+            def.state = ParseState(state);
+            is >> def.temperature >> def.pressure;
+            def.temperature *= kelvin;
+            def.pressure *= readUnit("pressure");
+        };
+
+        if (kind == "element") {
+            is >> def.symbol >> def.z >> def.a;
+            def.a *= g / mole;
+        } else if (kind == "simple") {
+            is >> def.z >> def.a;
+            def.a *= g / mole;
+            readConditions(true);
+        } else if ((kind == "compound") || (kind == "mixture")) {
+            readConditions(false);
+            G4String component;
+            G4double amount;
+            while (is >> component >> amount) {
+                def.components.emplace_back(component, amount);
+            }
+            if (def.components.empty()) {
+                G4cout << "<><><><><> ERROR: " << kind << " " << def.name << " has no components" << G4endl;
+                exit(1);
+            }
+        } else {
+            G4cout << "<><><><><> ERROR: material kind " << kind
+                   << " not valid, options: element simple compound mixture" << G4endl;
+            exit(1);
+        }
+
+        if (is.fail() && !is.eof()) {
+            G4cout << "<><><><><> ERROR: invalid " << kind << " definition: " << arguments << G4endl;
+            exit(1);
+        }
+        if (def.name.empty() || ((kind != "element") && (def.density <= 0.))) {
+            G4cout << "<><><><><> ERROR: invalid " << kind << " definition: " << arguments << G4endl;
+            exit(1);
+        }
+        return def;
+    }
+
+
+    std::vector<MaterialDefinition> MaterialRegistry::ReadDatabase(const G4String &fileName) {
+        std::ifstream file(fileName);
+        if (!file) {
+            G4cout << "<><><><><> ERROR: material database " << fileName << " not found" << G4endl;
+            exit(1);
+        }
+
+        std::vector<MaterialDefinition> defs;
+        std::string line;
+        while (std::getline(file, line)) {
+            const auto comment = line.find('#');
+            if (comment != std::string::npos) {
+                line.erase(comment);
+            }
+            std::istringstream is(line);
+            std::string kind;
+            if (!(is >> kind)) {
+                continue;
+            }
+            std::string arguments;
+            std::getline(is, arguments);
+            defs.push_back(Parse(kind, arguments));
+        }
+        return defs;
+    }
+
+
+    void MaterialRegistry::Define(const MaterialDefinition &def) {
+        if (def.kind == "element") {
+            if (fElements.count(def.name)) {
+                G4cout << "<><><><><> ERROR: element " << def.name << " is already in use, it cannot be redefined"
+                       << G4endl;
+                exit(1);
+            }
+            RegisterElement(def.name, [def]() { return new G4Element(def.name, def.symbol, def.z, def.a); });
+            return;
+        }
+
+        if (fMaterials.count(def.name) || G4Material::GetMaterial(def.name, false)) {
+            G4cout << "<><><><><> ERROR: material " << def.name << " is already in use, define it with a new name"
+                   << G4endl;
+            exit(1);
+        }
+        Register(def.name, [this, def]() { return Build(def); });
+    }
+
+
+    G4Material *MaterialRegistry::Build(const MaterialDefinition &def) {
+        const auto temperature = (def.temperature > 0.) ? def.temperature : NTP_Temperature;
+        const auto pressure = (def.pressure > 0.) ? def.pressure : STP_Pressure;
+
+        if (def.kind == "simple") {
+            return new G4Material(def.name, def.z, def.a, def.density, def.state, temperature, pressure);
+        }
+
+        auto mat = new G4Material(def.name, def.density, G4int(def.components.size()), def.state, temperature,
+                                  pressure);
+        for (const auto &component: def.components) {
+            if (def.kind == "compound") {
+                mat->AddElement(GetElement(component.first), G4int(component.second));
+            } else if (auto compMat = Get(component.first)) {
+                mat->AddMaterial(compMat, component.second);
+            } else {
+                mat->AddElement(GetElement(component.first), component.second);
+            }
+        }
+        return mat;
+    }
+
+
+    std::vector<G4String> MaterialRegistry::GetNames() const {
+        std::vector<G4String> names;
+        names.reserve(fFactories.size());
+        for (const auto &factory: fFactories) {
+            names.emplace_back(factory.first);
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+
+    void MaterialRegistry::PrintBuilt() const {
+        G4cout << G4endl << "The materials used are : " << G4endl;
+        for (const auto mat: fBuilt) {
+            G4cout << "    " << std::setw(16) << std::left << mat->GetName() << std::right << std::setw(14)
+                   << mat->GetDensity() / (g / cm3) << " g/cm3" << G4endl;
+        }
+        G4cout << G4endl;
+    }
+
+
+}
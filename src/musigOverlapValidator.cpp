@@ -0,0 +1,205 @@
+#include "musigOverlapValidator.h"
+
+#include <G4AffineTransform.hh>
+#include <G4LogicalVolume.hh>
+#include <G4VSolid.hh>
+#include <G4ios.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <set>
+#include <thread>
+#include <utility>
+
+
+namespace MuSiG {
+
+
+    namespace {
+
+        /// surface points of one placement, in the frame of its mother, waiting for the worker threads
+        struct OverlapTask {
+            G4VPhysicalVolume *pv;
+            std::size_t firstPoint;
+        };
+
+        /// points drawn before the tasks are handed to the threads, bounds the memory of a pass
+        const std::size_t kPointsPerPass = 1 << 20;
+
+    }
+
+
+    G4int OverlapValidator::Check(G4VPhysicalVolume *pv, const G4ThreeVector *points, G4String &other) const {
+        auto mother = pv->GetMotherLogical();
+        auto motherSolid = mother->GetSolid();
+
+        // mother frame -> frame of each sibling, nullptr solid for pv itself
+        const auto nDaughters = mother->GetNoDaughters();
+        std::vector<G4AffineTransform> toSibling(nDaughters);
+        std::vector<const G4VSolid *> siblingSolids(nDaughters, nullptr);
+        for (std::size_t i = 0; i < nDaughters; ++i) {
+            auto sibling = mother->GetDaughter(G4int(i));
+            if (sibling != pv) {
+                toSibling[i] = G4AffineTransform(sibling->GetRotation(), sibling->GetTranslation()).Inverse();
+                siblingSolids[i] = sibling->GetLogicalVolume()->GetSolid();
+            }
+        }
+
+        // same tests as G4PVPlacement::CheckOverlaps with no tolerance: a point of the surface of the placement
+        // outside its mother or inside a sibling
+        for (G4int n = 0; n < fSamples; ++n) {
+            const auto &point = points[n];
+            if ((motherSolid->Inside(point) == kOutside) && (motherSolid->DistanceToIn(point) > 0.)) {
+                other = mother->GetName();
+                return 1;
+            }
+            for (std::size_t i = 0; i < nDaughters; ++i) {
+                auto siblingSolid = siblingSolids[i];
+                if (!siblingSolid) {
+                    continue;
+                }
+                const auto local = toSibling[i].TransformPoint(point);
+                if ((siblingSolid->Inside(local) == kInside) && (siblingSolid->DistanceToOut(local) > 0.)) {
+                    other = mother->GetDaughter(G4int(i))->GetName();
+                    return 1;
+                }
+            }
+        }
+        return 0;
+    }
+
+
+    G4int OverlapValidator::Validate(G4VPhysicalVolume *world) {
+        fOverlapping.clear();
+        if (!world) {
+            return 0;
+        }
+
+        // every placement of every logical volume, in the order of the tree so that the points are the same
+        // from run to run; every logical volume is descended only once
+        std::vector<G4VPhysicalVolume *> placements;
+        std::set<G4LogicalVolume *> visited;
+        std::vector<G4LogicalVolume *> toVisit{world->GetLogicalVolume()};
+        while (!toVisit.empty()) {
+            auto mother = toVisit.back();
+            toVisit.pop_back();
+            if (!visited.insert(mother).second) {
+                continue;
+            }
+            for (std::size_t i = 0; i < mother->GetNoDaughters(); ++i) {
+                auto daughter = mother->GetDaughter(G4int(i));
+                placements.push_back(daughter);
+                toVisit.push_back(daughter->GetLogicalVolume());
+            }
+        }
+
+        G4int nThreads = fThreads > 0 ? fThreads : G4int(std::thread::hardware_concurrency());
+        nThreads = std::max(1, nThreads);
+
+        G4cout << ">>>>>>>>>> Checking overlaps of " << placements.size() << " placements with " << fSamples
+               << " points on " << nThreads << " threads" << G4endl;
+
+        // The random points are drawn here, on the calling thread, from the Geant4 engine, and everything that
+        // prints or raises a G4Exception runs here too. The worker threads only call the const Inside and
+        // DistanceToIn/Out of the solids of the mothers and siblings, and write their own result slot, so the
+        // result does not depend on the number of threads.
+        std::vector<G4ThreeVector> points;
+        std::vector<OverlapTask> tasks;
+        std::vector<std::pair<G4VPhysicalVolume *, G4String>> overlapping;
+
+        auto runPass = [&]() {
+            std::vector<G4int> overlaps(tasks.size(), 0);
+            std::vector<G4String> others(tasks.size());
+            std::atomic<std::size_t> next{0};
+            auto worker = [&]() {
+                for (auto i = next++; i < tasks.size(); i = next++) {
+                    overlaps[i] = Check(tasks[i].pv, &points[tasks[i].firstPoint], others[i]);
+                }
+            };
+            const auto nPassThreads = std::min(nThreads, G4int(tasks.size()));
+            std::vector<std::thread> threads;
+            for (G4int t = 1; t < nPassThreads; ++t) {
+                threads.emplace_back(worker);
+            }
+            worker();
+            for (auto &thread: threads) {
+                thread.join();
+            }
+            for (std::size_t i = 0; i < tasks.size(); ++i) {
+                if (overlaps[i]) {
+                    overlapping.emplace_back(tasks[i].pv, others[i]);
+                }
+            }
+            tasks.clear();
+            points.clear();
+        };
+
+        for (auto pv: placements) {
+            if (pv->IsReplicated()) {
+                // a parameterised volume changes its own transformation for every copy, it is checked here with
+                // the Geant4 check; replicas are not checked by Geant4 either
+                if (pv->IsParameterised() && pv->CheckOverlaps(fSamples, 0., false, 1)) {
+                    overlapping.emplace_back(pv, G4String());
+                }
+                continue;
+            }
+
+            const G4AffineTransform toMother(pv->GetRotation(), pv->GetTranslation());
+            auto solid = pv->GetLogicalVolume()->GetSolid();
+            tasks.push_back(OverlapTask{pv, points.size()});
+            for (G4int n = 0; n < fSamples; ++n) {
+                points.push_back(toMother.TransformPoint(solid->GetPointOnSurface()));
+            }
+            if (points.size() >= kPointsPerPass) {
+                runPass();
+            }
+        }
+        if (!tasks.empty()) {
+            runPass();
+        }
+
+        for (const auto &overlap: overlapping) {
+            auto pv = overlap.first;
+            fOverlapping.push_back(pv);
+            G4cout << "<><><><><> WARNING: volume " << pv->GetName() << " (copy " << pv->GetCopyNo()
+                   << ") overlaps";
+            if (!overlap.second.empty()) {
+                G4cout << " " << overlap.second;
+            }
+            G4cout << G4endl;
+        }
+
+        return G4int(fOverlapping.size());
+    }
+
+
+    G4bool OverlapValidator::IsValidated(const G4String &cacheFile, const G4String &digest) {
+        if (cacheFile.empty()) {
+            return false;
+        }
+        std::ifstream in(cacheFile);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line == digest) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    void OverlapValidator::MarkValidated(const G4String &cacheFile, const G4String &digest) {
+        if (cacheFile.empty() || IsValidated(cacheFile, digest)) {
+            return;
+        }
+        std::ofstream out(cacheFile, std::ios::app);
+        if (!out) {
+            G4cout << "<><><><><> WARNING: cannot write overlap cache " << cacheFile << G4endl;
+            return;
+        }
+        out << digest << "\n";
+    }
+
+
+}
@@ -0,0 +1,236 @@
+#include "musigShapeTable.h"
+
+#include <G4UIcommand.hh>
+#include <G4ios.hh>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace MuSiG {
+
+
+    namespace {
+
+        const std::size_t kMinFields = 15;
+        const std::size_t kMaxFields = 16;
+
+        /// read-only view of a whole file, memory mapped where available
+        class MappedFile {
+        public:
+            explicit MappedFile(const G4String &fileName) {
+#ifdef _WIN32
+                std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+                if (!file) {
+                    return;
+                }
+                fCopy.resize(std::size_t(file.tellg()));
+                file.seekg(0);
+                file.read(&fCopy[0], std::streamsize(fCopy.size()));
+                fData = fCopy.data();
+                fSize = fCopy.size();
+                fOpen = static_cast<G4bool>(file);
+#else
+                const auto fd = open(fileName.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    return;
+                }
+                struct stat info;
+                if (fstat(fd, &info) == 0) {
+                    fSize = std::size_t(info.st_size);
+                    fOpen = true;
+                    if (fSize > 0) {
+                        auto data = mmap(nullptr, fSize, PROT_READ, MAP_PRIVATE, fd, 0);
+                        if (data == MAP_FAILED) {
+                            fOpen = false;
+                        } else {
+                            fData = static_cast<const char *>(data);
+                            madvise(data, fSize, MADV_SEQUENTIAL);
+                        }
+                    }
+                }
+                close(fd);
+#endif
+            }
+
+            ~MappedFile() {
+#ifndef _WIN32
+                if (fData) {
+                    munmap(const_cast<char *>(fData), fSize);
+                }
+#endif
+            }
+
+            MappedFile(const MappedFile &) = delete;
+
+            MappedFile &operator=(const MappedFile &) = delete;
+
+            G4bool IsOpen() const { return fOpen; }
+
+            const char *Begin() const { return fData; }
+
+            const char *End() const { return fData + fSize; }
+
+        private:
+            const char *fData = nullptr;
+            std::size_t fSize = 0;
+            G4bool fOpen = false;
+#ifdef _WIN32
+            std::string fCopy;
+#endif
+        };
+
+        struct Field {
+            const char *begin;
+            const char *end;
+
+            std::string String() const { return std::string(begin, end); }
+
+            G4bool Is(const char *text) const {
+                const auto size = std::strlen(text);
+                return (std::size_t(end - begin) == size) && (std::memcmp(begin, text, size) == 0);
+            }
+        };
+
+        void TableError(const G4String &fileName, G4int lineNumber, const G4String &what) {
+            G4cout << "<><><><><> ERROR: import table " << fileName << " line " << lineNumber << ": " << what
+                   << G4endl;
+            exit(1);
+        }
+
+    }
+
+
+    std::vector<DetShapeDefinition> ShapeTable::Read(const G4String &fileName) {
+        MappedFile file(fileName);
+        if (!file.IsOpen()) {
+            G4cout << "<><><><><> ERROR: import table " << fileName << " cannot be read" << G4endl;
+            exit(1);
+        }
+
+        std::vector<DetShapeDefinition> defs;
+        std::vector<Field> fields;
+        fields.reserve(kMaxFields);
+        // units are looked up once per file, not once per field
+        std::unordered_map<std::string, G4double> units;
+        std::string number;
+        char separator = 0;
+        G4bool firstLine = true;
+        G4int lineNumber = 0;
+
+        auto unitValue = [&](const Field &field) {
+            auto unit = field.String();
+            auto found = units.find(unit);
+            if (found == units.end()) {
+                const auto value = G4UIcommand::ValueOf(unit.c_str());
+                if (value <= 0.) {
+                    TableError(fileName, lineNumber, "unknown unit " + unit);
+                }
+                found = units.emplace(unit, value).first;
+            }
+            return found->second;
+        };
+        auto toDouble = [&](const Field &field) {
+            number.assign(field.begin, field.end);
+            char *end = nullptr;
+            const auto value = std::strtod(number.c_str(), &end);
+            if (number.empty() || (*end != '\0')) {
+                TableError(fileName, lineNumber, "invalid number >" + number + "<");
+            }
+            return value;
+        };
+        auto toVector = [&](std::size_t first) {
+            return G4ThreeVector(toDouble(fields[first]), toDouble(fields[first + 1]), toDouble(fields[first + 2]));
+        };
+
+        for (auto pos = file.Begin(); pos < file.End();) {
+            auto lineEnd = static_cast<const char *>(std::memchr(pos, '\n', std::size_t(file.End() - pos)));
+            if (!lineEnd) {
+                lineEnd = file.End();
+            }
+            const auto lineBegin = pos;
+            pos = lineEnd + 1;
+            ++lineNumber;
+
+            auto end = lineEnd;
+            while ((end > lineBegin) && ((end[-1] == '\r') || (end[-1] == ' ') || (end[-1] == '\t'))) {
+                --end;
+            }
+            auto begin = lineBegin;
+            while ((begin < end) && (*begin == ' ')) {
+                ++begin;
+            }
+            if ((begin == end) || (*begin == '#')) {
+                continue;
+            }
+
+            // tab separated if the first line has a tab, comma separated otherwise
+            if (!separator) {
+                separator = std::memchr(begin, '\t', std::size_t(end - begin)) ? '\t' : ',';
+            }
+
+            fields.clear();
+            for (auto fieldBegin = begin;;) {
+                auto fieldEnd = static_cast<const char *>(std::memchr(fieldBegin, separator,
+                                                                        std::size_t(end - fieldBegin)));
+                const G4bool last = (fieldEnd == nullptr);
+                if (last) {
+                    fieldEnd = end;
+                }
+                Field field{fieldBegin, fieldEnd};
+                while ((field.begin < field.end) && (*field.begin == ' ')) {
+                    ++field.begin;
+                }
+                while ((field.end > field.begin) && (field.end[-1] == ' ')) {
+                    --field.end;
+                }
+                fields.push_back(field);
+                if (last) {
+                    break;
+                }
+                fieldBegin = fieldEnd + 1;
+            }
+
+            if (firstLine) {
+                firstLine = false;
+                if (fields.front().Is("shape")) {
+                    continue;
+                }
+            }
+
+            if ((fields.size() < kMinFields) || (fields.size() > kMaxFields)) {
+                TableError(fileName, lineNumber, "expected " + std::to_string(kMinFields) + " or " +
+                                                 std::to_string(kMaxFields) + " fields, found " +
+                                                 std::to_string(fields.size()));
+            }
+            if (!fields[0].Is("box") && !fields[0].Is("tubs")) {
+                TableError(fileName, lineNumber, "invalid shape " + fields[0].String() + ", options: box, tubs");
+            }
+
+            DetShapeDefinition def;
+            def.shape = fields[0].String();
+            def.params.name = fields[1].String();
+            def.params.mat = fields[2].String();
+            def.params.size = toVector(3) * unitValue(fields[6]);
+            def.params.pos = toVector(7) * unitValue(fields[10]);
+            def.params.rot = toVector(11);
+            def.params.mother = fields[14].String();
+            def.params.booltype = (fields.size() == kMaxFields) ? fields[15].String() : G4String("A");
+            defs.push_back(def);
+        }
+        return defs;
+    }
+
+
+}
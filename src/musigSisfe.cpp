@@ -1,24 +1,23 @@
 #include "musigSisfe.h"
 
+#include <G4NavigationHistory.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_set>
+
 namespace MuSiG {
 
 sisfeGeometry::sisfeGeometry()
 {
-    // setting every block colour to white
-    m_colorContainer = new G4VisAttributes(G4Colour(1, 1, 1));
-    m_colorLiqHe = new G4VisAttributes(G4Colour(1, 1, 1));
-    m_colorSi = new G4VisAttributes(G4Colour(1, 1, 1));
+    // every block colour is white by default
 }
 
 sisfeGeometry::sisfeGeometry(G4String nameID)
 {
     // setting names
     SetNameID(nameID);
-
-    // setting every block colour to white
-    m_colorContainer = new G4VisAttributes(G4Colour(1, 1, 1));
-    m_colorLiqHe = new G4VisAttributes(G4Colour(1, 1, 1));
-    m_colorSi = new G4VisAttributes(G4Colour(1, 1, 1));
 }
 
 sisfeGeometry::sisfeGeometry(G4LogicalVolume *logicWorld, G4String nameID, G4int nLiqHe, G4double LiqHeDimX, G4double LiqHeDimY, G4double LiqHeDimZ, G4double SiDimX, G4double SiDimY, G4double SiDimZ, G4ThreeVector position, G4RotationMatrix *rot)
@@ -35,13 +34,52 @@ sisfeGeometry::~sisfeGeometry() {}
 
 void sisfeGeometry::Geometry(G4LogicalVolume *logicWorld)
 {
+    // the object is reused for every grid, forget the volumes of the previous one
+    m_solidGap = nullptr;
+    m_logicGap = nullptr;
+    m_physGap = nullptr;
+    m_gapParam = nullptr;
+    m_solidCells = nullptr;
+    m_logicCells = nullptr;
+    m_physCells = nullptr;
+    m_solidCell = nullptr;
+    m_logicCell = nullptr;
+    m_physCell = nullptr;
+    m_solidLayer = nullptr;
+    m_logicLayer = nullptr;
+    m_physLayer = nullptr;
+    m_solidRow = nullptr;
+    m_logicRow = nullptr;
+    m_physRow = nullptr;
+    m_solidLiqHe = nullptr;
+    m_logicLiqHe = nullptr;
+    m_physLiqHe = nullptr;
+    m_mother = logicWorld;
+
     // creating the geometry of the container
     m_solidContainer = new G4Box(m_nameSolidContainer, 0.5 * m_WorldDimX, 0.5 * m_WorldDimY, 0.5 * m_WorldDimZ);
     m_logicContainer = new G4LogicalVolume(m_solidContainer, m_Vacuum, m_nameLogicContainer, nullptr, nullptr, nullptr);
     m_logicContainer->SetVisAttributes(m_colorContainer);
-    m_physContainer = new G4PVPlacement(m_rot, m_position, m_logicContainer, m_namePhysContainer, logicWorld, false, 0, true);
+    m_physContainer = new G4PVPlacement(m_rot, m_position, m_logicContainer, m_namePhysContainer, logicWorld, false, 0, m_checkOverlaps);
+    if (m_region)
+        m_region->AddRootLogicalVolume(m_logicContainer);
 
-    // placing the LiqHe and Si columns
+    if (m_placement == "param")
+        ParameterisePillars();
+    else if (m_placement == "replica")
+        ReplicateCells();
+    else if (m_placement == "lattice")
+        BuildLattice();
+    else
+        PlacePillars();
+
+    RegisterVolumes(m_logicContainer);
+}
+
+void sisfeGeometry::PlacePillars()
+{
+    // placing the LiqHe and Si columns, every pillar is a logical volume of its own: the reference layout of the
+    // other placement modes, its pillar volumes are never shared with another grid
     m_solidLiqHe = new G4Box(m_nameSolidLiqHe, 0.5 * m_LiqHeDimX, 0.5 * m_LiqHeDimY, 0.5 * m_LiqHeDimZ);
 
     m_solidSi = new G4Box(m_nameSolidSi, 0.5 * m_SiDimX, 0.5 * m_SiDimY, 0.5 * m_SiDimZ);
@@ -56,17 +94,136 @@ void sisfeGeometry::Geometry(G4LogicalVolume *logicWorld)
         {
             m_logicSi = new G4LogicalVolume(m_solidSi, m_Si, m_nameLogicSi, nullptr, nullptr, nullptr);
             m_logicSi->SetVisAttributes(m_colorSi);
-            m_physSi = new G4PVPlacement(0, G4ThreeVector(start + i * step, 0., 0.), m_logicSi, m_namePhysSi, m_logicContainer, false, i, true);
+            m_physSi = new G4PVPlacement(0, G4ThreeVector(start + i * step, 0., 0.), m_logicSi, m_namePhysSi, m_logicContainer, false, i, m_checkOverlaps);
         }
         else
         {
             m_logicLiqHe = new G4LogicalVolume(m_solidLiqHe, m_LiqHe, m_nameLogicLiqHe, nullptr, nullptr, nullptr);
             m_logicLiqHe->SetVisAttributes(m_colorLiqHe);
-            m_physLiqHe = new G4PVPlacement(0, G4ThreeVector(start + i * step, -(m_SiDimY / 2 - m_LiqHeDimY / 2), 0.), m_logicLiqHe, m_namePhysLiqHe, m_logicContainer, false, i, true);
+            m_physLiqHe = new G4PVPlacement(0, G4ThreeVector(start + i * step, -(m_SiDimY / 2 - m_LiqHeDimY / 2), 0.), m_logicLiqHe, m_namePhysLiqHe, m_logicContainer, false, i, m_checkOverlaps);
         }
     }
 }
 
+void sisfeGeometry::ParameterisePillars()
+{
+    // a parameterised volume has to be the only daughter of its mother, so the Si pillars are built as one Si block
+    // filling the container and the gaps between them are parameterised inside it. Every gap holds one LiqHe column,
+    // so the whole grid is made of one Si, one gap and one LiqHe logical volume whatever the number of columns.
+    m_solidSi = new G4Box(m_nameSolidSi, 0.5 * m_WorldDimX, 0.5 * m_SiDimY, 0.5 * m_SiDimZ);
+    m_logicSi = new G4LogicalVolume(m_solidSi, m_Si, m_nameLogicSi, nullptr, nullptr, nullptr);
+    m_logicSi->SetVisAttributes(m_colorSi);
+    m_physSi = new G4PVPlacement(0, G4ThreeVector(), m_logicSi, m_namePhysSi, m_logicContainer, false, 0, m_checkOverlaps);
+
+    if (m_nLiqHe == 0)
+        return;
+
+    m_solidGap = new G4Box(m_nameSolidGap, 0.5 * m_LiqHeDimX, 0.5 * m_SiDimY, 0.5 * m_SiDimZ);
+    m_logicGap = new G4LogicalVolume(m_solidGap, m_Vacuum, m_nameLogicGap, nullptr, nullptr, nullptr);
+    m_logicGap->SetVisAttributes(m_colorContainer);
+
+    const auto start = -m_WorldDimX / 2 + m_SiDimX + m_LiqHeDimX / 2;
+    const auto pitch = m_SiDimX + m_LiqHeDimX;
+    m_gapParam = m_arena ? m_arena->Make<sisfePillarParameterisation>(start, pitch, 0.) : new sisfePillarParameterisation(start, pitch, 0.);
+    m_physGap = new G4PVParameterised(m_namePhysGap, m_logicGap, m_logicSi, kXAxis, m_nLiqHe, m_gapParam, m_checkOverlaps);
+
+    m_logicLiqHe = PillarVolume(sisfeVolumeType::LiqHe, m_LiqHeDimX, m_LiqHeDimY, m_LiqHeDimZ);
+    m_solidLiqHe = static_cast<G4Box *>(m_logicLiqHe->GetSolid());
+    m_physLiqHe = new G4PVPlacement(0, G4ThreeVector(0., -(m_SiDimY / 2 - m_LiqHeDimY / 2), 0.), m_logicLiqHe, m_namePhysLiqHe, m_logicGap, false, 0, m_checkOverlaps);
+}
+
+void sisfeGeometry::ReplicateCells()
+{
+    // the grid is a row of nLiqHe (Si + LiqHe) unit cells closed by a last Si wall. The cells are replicas along X,
+    // so the navigator finds the cell of a point from its X coordinate instead of searching all the pillars.
+    m_logicSi = PillarVolume(sisfeVolumeType::Si, m_SiDimX, m_SiDimY, m_SiDimZ);
+    m_solidSi = static_cast<G4Box *>(m_logicSi->GetSolid());
+
+    // last Si wall, its copy number is the index of its column
+    m_physSi = new G4PVPlacement(0, G4ThreeVector(m_WorldDimX / 2 - m_SiDimX / 2, 0., 0.), m_logicSi, m_namePhysSi, m_logicContainer, false, m_nLiqHe, m_checkOverlaps);
+
+    if (m_nLiqHe == 0)
+        return;
+
+    const auto pitch = m_SiDimX + m_LiqHeDimX;
+
+    // a replica has to fill its mother, so the cells get their own mother next to the last Si wall
+    m_solidCells = new G4Box(m_nameSolidCells, 0.5 * m_nLiqHe * pitch, 0.5 * m_SiDimY, 0.5 * m_SiDimZ);
+    m_logicCells = new G4LogicalVolume(m_solidCells, m_Vacuum, m_nameLogicCells, nullptr, nullptr, nullptr);
+    m_logicCells->SetVisAttributes(m_colorContainer);
+    m_physCells = new G4PVPlacement(0, G4ThreeVector(-m_SiDimX / 2, 0., 0.), m_logicCells, m_namePhysCells, m_logicContainer, false, 0, m_checkOverlaps);
+
+    m_solidCell = new G4Box(m_nameSolidCell, 0.5 * pitch, 0.5 * m_SiDimY, 0.5 * m_SiDimZ);
+    m_logicCell = new G4LogicalVolume(m_solidCell, m_Vacuum, m_nameLogicCell, nullptr, nullptr, nullptr);
+    m_logicCell->SetVisAttributes(m_colorContainer);
+    m_physCell = new G4PVReplica(m_namePhysCell, m_logicCell, m_logicCells, kXAxis, m_nLiqHe, pitch);
+
+    new G4PVPlacement(0, G4ThreeVector(-pitch / 2 + m_SiDimX / 2, 0., 0.), m_logicSi, m_namePhysSi, m_logicCell, false, 0, m_checkOverlaps);
+
+    m_logicLiqHe = PillarVolume(sisfeVolumeType::LiqHe, m_LiqHeDimX, m_LiqHeDimY, m_LiqHeDimZ);
+    m_solidLiqHe = static_cast<G4Box *>(m_logicLiqHe->GetSolid());
+    m_physLiqHe = new G4PVPlacement(0, G4ThreeVector(pitch / 2 - m_LiqHeDimX / 2, -(m_SiDimY / 2 - m_LiqHeDimY / 2), 0.), m_logicLiqHe, m_namePhysLiqHe, m_logicCell, false, 0, m_checkOverlaps);
+}
+
+void sisfeGeometry::BuildLattice()
+{
+    // the container is filled by nested replicas: layers along Z, rows along Y and cells along X. Every cell holds the
+    // same post(s), so the grid is made of a handful of logical and physical volumes whatever the number of cells and
+    // the navigator finds the cell of a point from its coordinates. A hexagonal lattice uses a rectangular cell two
+    // rows high with two posts, the second row shifted by half a pitch.
+    const auto fill = m_Fill ? m_Fill : m_LiqHe;
+    const auto hex = (m_latticeCell == "hex");
+    const auto nRows = hex ? m_latticeNY / 2 : m_latticeNY;
+    const auto rowPitch = hex ? 2 * m_pitchY : m_pitchY;
+
+    m_solidLayer = new G4Box(m_nameSolidLayer, 0.5 * m_WorldDimX, 0.5 * m_WorldDimY, 0.5 * m_SiDimZ);
+    m_logicLayer = new G4LogicalVolume(m_solidLayer, fill, m_nameLogicLayer, nullptr, nullptr, nullptr);
+    m_logicLayer->SetVisAttributes(m_colorContainer);
+    m_physLayer = new G4PVReplica(m_namePhysLayer, m_logicLayer, m_logicContainer, kZAxis, m_latticeNLayers, m_SiDimZ);
+
+    m_solidRow = new G4Box(m_nameSolidRow, 0.5 * m_WorldDimX, 0.5 * rowPitch, 0.5 * m_SiDimZ);
+    m_logicRow = new G4LogicalVolume(m_solidRow, fill, m_nameLogicRow, nullptr, nullptr, nullptr);
+    m_logicRow->SetVisAttributes(m_colorContainer);
+    m_physRow = new G4PVReplica(m_namePhysRow, m_logicRow, m_logicLayer, kYAxis, nRows, rowPitch);
+
+    m_solidCell = new G4Box(m_nameSolidCell, 0.5 * m_pitchX, 0.5 * rowPitch, 0.5 * m_SiDimZ);
+    m_logicCell = new G4LogicalVolume(m_solidCell, fill, m_nameLogicCell, nullptr, nullptr, nullptr);
+    m_logicCell->SetVisAttributes(m_colorLiqHe);
+    m_physCell = new G4PVReplica(m_namePhysCell, m_logicCell, m_logicRow, kXAxis, m_latticeNX, m_pitchX);
+
+    m_logicSi = PillarVolume(sisfeVolumeType::Si, m_SiDimX, m_SiDimY, m_SiDimZ);
+    m_solidSi = static_cast<G4Box *>(m_logicSi->GetSolid());
+    if (hex)
+    {
+        m_physSi = new G4PVPlacement(0, G4ThreeVector(-m_pitchX / 4, -m_pitchY / 2, 0.), m_logicSi, m_namePhysSi, m_logicCell, false, 0, m_checkOverlaps);
+        new G4PVPlacement(0, G4ThreeVector(m_pitchX / 4, m_pitchY / 2, 0.), m_logicSi, m_namePhysSi, m_logicCell, false, 1, m_checkOverlaps);
+    }
+    else
+    {
+        m_physSi = new G4PVPlacement(0, G4ThreeVector(), m_logicSi, m_namePhysSi, m_logicCell, false, 0, m_checkOverlaps);
+    }
+}
+
+G4LogicalVolume *sisfeGeometry::PillarVolume(sisfeVolumeType type, G4double dimX, G4double dimY, G4double dimZ)
+{
+    const auto isSi = (type == sisfeVolumeType::Si);
+    const auto material = isSi ? m_Si : m_LiqHe;
+    const auto colour = isSi ? m_colorSi : m_colorLiqHe;
+    const auto key = std::make_tuple(type, dimX, dimY, dimZ, material, colour, m_region, m_mother);
+    if (m_sharePillars)
+    {
+        if (auto logic = m_registry->FindPillar(key))
+            return logic;
+    }
+
+    auto solid = new G4Box(isSi ? m_nameSolidSi : m_nameSolidLiqHe, 0.5 * dimX, 0.5 * dimY, 0.5 * dimZ);
+    auto logic = new G4LogicalVolume(solid, material, isSi ? m_nameLogicSi : m_nameLogicLiqHe, nullptr, nullptr, nullptr);
+    logic->SetVisAttributes(colour);
+    if (m_sharePillars)
+        m_registry->AddPillar(key, logic);
+    return logic;
+}
+
 void sisfeGeometry::SetNameID(G4String nameID)
 {
     // setting namesID
@@ -82,6 +239,101 @@ void sisfeGeometry::SetNameID(G4String nameID)
     m_nameSolidSi = nameID + "solidSi";
     m_nameLogicSi = nameID + "logicSi";
     m_namePhysSi = nameID + "phySi";
+
+    m_nameSolidGap = nameID + "solidGap";
+    m_nameLogicGap = nameID + "logicGap";
+    m_namePhysGap = nameID + "phyGap";
+
+    m_nameSolidCells = nameID + "solidCells";
+    m_nameLogicCells = nameID + "logicCells";
+    m_namePhysCells = nameID + "phyCells";
+
+    m_nameSolidCell = nameID + "solidCell";
+    m_nameLogicCell = nameID + "logicCell";
+    m_namePhysCell = nameID + "phyCell";
+
+    m_nameSolidLayer = nameID + "solidLayer";
+    m_nameLogicLayer = nameID + "logicLayer";
+    m_namePhysLayer = nameID + "phyLayer";
+
+    m_nameSolidRow = nameID + "solidRow";
+    m_nameLogicRow = nameID + "logicRow";
+    m_namePhysRow = nameID + "phyRow";
+}
+
+void sisfeGeometry::SetPlacement(G4String placement)
+{
+    if (placement != "place" && placement != "param" && placement != "replica" && placement != "lattice")
+    {
+        G4cout << "<><><><><> ERROR: invalid sisfe placement " << placement << ", options: place, param, replica, lattice \n";
+        exit(1);
+    }
+    m_placement = placement;
+}
+
+void sisfeGeometry::SetLattice(G4int nX, G4int nY, G4int nLayers, G4double pitchX, G4double pitchY, G4String cell)
+{
+    if (cell != "square" && cell != "hex")
+    {
+        G4cout << "<><><><><> ERROR: invalid sisfe lattice cell " << cell << ", options: square, hex \n";
+        exit(1);
+    }
+    if (nX <= 0 || nY <= 0 || nLayers <= 0)
+    {
+        G4cout << "<><><><><> ERROR: invalid number of sisfe lattice cells \n";
+        exit(1);
+    }
+    if (cell == "hex" && nY % 2 != 0)
+    {
+        G4cout << "<><><><><> ERROR: a hex sisfe lattice needs an even number of rows \n";
+        exit(1);
+    }
+    if (pitchX <= 0. || pitchY <= 0.)
+    {
+        G4cout << "<><><><><> ERROR: invalid sisfe lattice pitch \n";
+        exit(1);
+    }
+    m_latticeNX = nX;
+    m_latticeNY = nY;
+    m_latticeNLayers = nLayers;
+    m_pitchX = pitchX;
+    m_pitchY = pitchY;
+    m_latticeCell = cell;
+}
+
+void sisfeGeometry::SetFillMaterial(G4Material *fill)
+{
+    m_Fill = fill;
+}
+
+void sisfeGeometry::SetArena(GeometryArena *arena)
+{
+    m_arena = arena;
+}
+
+void sisfeGeometry::SetRegistry(std::shared_ptr<sisfeVolumeRegistry> registry)
+{
+    m_registry = std::move(registry);
+}
+
+void sisfeGeometry::SetSharePillars(G4bool share)
+{
+    m_sharePillars = share;
+}
+
+void sisfeGeometry::SetRegion(G4Region *region)
+{
+    m_region = region;
+}
+
+void sisfeGeometry::ApplyRegion()
+{
+    // registers the container of this grid when it was not built by this object (e.g. read from GDML)
+    if (!m_region)
+        return;
+    auto logic = G4LogicalVolumeStore::GetInstance()->GetVolume(m_nameLogicContainer, false);
+    if (logic)
+        m_region->AddRootLogicalVolume(logic);
 }
 
 void sisfeGeometry::DefineMaterials()
@@ -142,6 +394,24 @@ void sisfeGeometry::MakeGeometry(G4LogicalVolume *logicWorld, G4int nLiqHe, G4do
         exit(1);
     }
 
+    if (m_placement == "lattice")
+    {
+        // the posts have to fit in their cell, a hex cell holds two of them side by side
+        const auto cellX = (m_latticeCell == "hex") ? m_pitchX / 2 : m_pitchX;
+        if (m_latticeNX == 0 || m_SiDimX > cellX || m_SiDimY > m_pitchY)
+        {
+            G4cout << "<><><><><> ERROR: invalid sisfe lattice, the Si posts do not fit the lattice pitch \n";
+            exit(1);
+        }
+        m_WorldDimX = m_latticeNX * m_pitchX;
+        m_WorldDimY = m_latticeNY * m_pitchY;
+        m_WorldDimZ = m_latticeNLayers * m_SiDimZ;
+        m_position = position;
+        m_rot = rot;
+        Geometry(logicWorld);
+        return;
+    }
+
     // setting the container (world) dimensions
     m_WorldDimX = m_nLiqHe * m_LiqHeDimX + m_nSi * m_SiDimX;
     if (SiDimY >= LiqHeDimY)
@@ -169,40 +439,11 @@ void sisfeGeometry::MakeGeometry(G4LogicalVolume *logicWorld, G4String nameID, G
     MakeGeometry(logicWorld, nLiqHe, LiqHeDimX, LiqHeDimY, LiqHeDimZ, SiDimX, SiDimY, SiDimZ, position, rot);
 }
 
-G4VisAttributes *sisfeGeometry::ifColors(G4String color)
+const G4VisAttributes *sisfeGeometry::ifColors(G4String color)
 {
-    auto RedVisAtt = new G4VisAttributes(G4Colour(1.0, 0.2, 0.2));
-    auto BlueVisAtt = new G4VisAttributes(G4Colour(0.0, 127, 255));
-    auto GreenVisAtt = new G4VisAttributes(G4Colour(0.5, 1.0, 0.5));
-    auto YellowVisAtt = new G4VisAttributes(G4Colour(1.0, 1.0, 0.));
-    auto MagentaVisAtt = new G4VisAttributes(G4Colour(1.0, 0.0, 1.));
-    auto WhiteVisAtt = new G4VisAttributes(G4Colour(1, 1, 1));
-    auto InvisibleVisAtt = new G4VisAttributes(G4VisAttributes::GetInvisible());
-    if (color == "Red" || color == "red" || color == "RED")
-    {
-        return RedVisAtt;
-    }
-    else if (color == "Blue" || color == "blue" || color == "BLUE")
-    {
-        return BlueVisAtt;
-    }
-    else if (color == "Green" || color == "green" || color == "GREEN")
-    {
-        return GreenVisAtt;
-    }
-    else if (color == "Yellow" || color == "yellow" || color == "YELLOW")
-    {
-        return YellowVisAtt;
-    }
-    else if (color == "Magenta" || color == "magenta" || color == "MAGENTA")
-    {
-        return MagentaVisAtt;
-    }
-    else if (color == "invisible" || color == "Invisible" || color == "INVISIBLE")
-    {
-        return InvisibleVisAtt;
-    }
-    return WhiteVisAtt;
+    // interned by the palette, white for an unknown colour
+    auto attributes = VisPalette::Instance().Get(color);
+    return attributes ? attributes : VisPalette::Instance().Get("white");
 }
 
 void sisfeGeometry::SetContainerColour(G4String colorContainer)
@@ -225,11 +466,38 @@ void sisfeGeometry::SetColours(G4String colorContainer, G4String colorLiqHe, G4S
     SetSiColour(colorSi);
 }
 
+void sisfeGeometry::ApplyColours()
+{
+    // sets the colours on volumes of this grid that were not built by this object (e.g. read from GDML)
+    for (auto logic : *G4LogicalVolumeStore::GetInstance())
+    {
+        const auto &name = logic->GetName();
+        if (name == m_nameLogicContainer || name == m_nameLogicGap || name == m_nameLogicCells || name == m_nameLogicLayer || name == m_nameLogicRow)
+            logic->SetVisAttributes(m_colorContainer);
+        else if (name == m_nameLogicCell)
+            logic->SetVisAttributes(m_placement == "lattice" ? m_colorLiqHe : m_colorContainer);
+        else if (name == m_nameLogicLiqHe)
+            logic->SetVisAttributes(m_colorLiqHe);
+        else if (name == m_nameLogicSi)
+            logic->SetVisAttributes(m_colorSi);
+    }
+}
+
 const G4String sisfeGeometry::GetNameID()
 {
     return m_nameID;
 }
 
+void sisfeGeometry::SetCheckOverlaps(G4bool checkOverlaps)
+{
+    m_checkOverlaps = checkOverlaps;
+}
+
+const G4String sisfeGeometry::GetPlacement()
+{
+    return m_placement;
+}
+
 const G4String sisfeGeometry::GetNameSolidContainer()
 {
     return m_nameSolidContainer;
@@ -306,6 +574,237 @@ const G4LogicalVolume *sisfeGeometry::GetLogicalSi()
     return m_logicSi;
 }
 
+std::vector<G4LogicalVolume *> sisfeGeometry::GetLogicalVolumes()
+{
+    std::vector<G4LogicalVolume *> volumes;
+    for (auto logic : {m_logicContainer, m_logicSi, m_logicGap, m_logicCells, m_logicCell, m_logicLayer, m_logicRow, m_logicLiqHe})
+    {
+        if (logic)
+            volumes.push_back(logic);
+    }
+    return volumes;
+}
+
+std::vector<G4String> sisfeGeometry::GetLogicalVolumeNames(const G4String &nameID)
+{
+    // the container first
+    std::vector<G4String> names;
+    for (auto suffix : {"logicContainer", "logicSi", "logicGap", "logicCells", "logicCell", "logicLayer", "logicRow", "logicLiqHe"})
+        names.push_back(nameID + suffix);
+    return names;
+}
+
+void sisfeGeometry::RegisterVolumes(G4LogicalVolume *container)
+{
+    m_registry->Register(container);
+}
+
+void sisfeGeometry::ForgetVolume(const G4LogicalVolume *logic)
+{
+    m_registry->Forget(logic);
+}
+
+void sisfeGeometry::ForgetVolumes()
+{
+    m_registry->Clear();
+}
+
+G4bool sisfeGeometry::IsShared(const G4LogicalVolume *logic) const
+{
+    return m_registry->IsShared(logic);
+}
+
+sisfePillarId sisfeGeometry::Identify(const G4VTouchable *touchable, const G4ThreeVector &globalPosition) const
+{
+    return m_registry->Identify(touchable, globalPosition);
+}
+
+namespace
+{
+const std::string kContainerSuffix = "logicContainer";
+
+G4bool EndsWith(const G4String &name, const std::string &suffix)
+{
+    return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+}
+
+void sisfeVolumeRegistry::Register(G4LogicalVolume *container)
+{
+    if (!container)
+        return;
+
+    // the names are compared once here, Identify only looks the logical volumes up. The shape of the grid is read
+    // from its volumes, so a grid read from GDML is registered the same way as a built one.
+    auto &shape = m_grids[container];
+    shape = sisfeGridShape();
+    shape.container = container;
+    const auto &containerName = container->GetName();
+    shape.nameID = EndsWith(containerName, kContainerSuffix) ? G4String(containerName.substr(0, containerName.size() - kContainerSuffix.size())) : containerName;
+    shape.worldDimX = 2 * static_cast<const G4Box *>(container->GetSolid())->GetXHalfLength();
+    G4double gapDimX = 0.;
+    std::size_t nPostsInCell = 0;
+
+    std::unordered_set<const G4LogicalVolume *> visited;
+    std::vector<G4LogicalVolume *> pending{container};
+    while (!pending.empty())
+    {
+        auto logic = pending.back();
+        pending.pop_back();
+        if (!visited.insert(logic).second)
+            continue;
+
+        const auto &name = logic->GetName();
+        auto type = sisfeVolumeType::Gap;
+        if (logic == container)
+            type = sisfeVolumeType::Container;
+        else if (EndsWith(name, "logicSi"))
+            type = sisfeVolumeType::Si;
+        else if (EndsWith(name, "logicLiqHe"))
+            type = sisfeVolumeType::LiqHe;
+        else if (EndsWith(name, "logicGap"))
+        {
+            shape.placement = "param";
+            gapDimX = 2 * static_cast<const G4Box *>(logic->GetSolid())->GetXHalfLength();
+        }
+        else if (EndsWith(name, "logicCells"))
+            shape.placement = "replica";
+        else if (EndsWith(name, "logicLayer"))
+            shape.placement = "lattice";
+        else if (EndsWith(name, "logicCell"))
+            nPostsInCell = logic->GetNoDaughters();
+        m_types[logic] = type;
+        if (type == sisfeVolumeType::Si || type == sisfeVolumeType::LiqHe)
+            m_users[logic].insert(container);
+
+        for (std::size_t i = 0; i < logic->GetNoDaughters(); ++i)
+        {
+            auto daughter = logic->GetDaughter(G4int(i));
+            if (daughter->IsParameterised())
+                shape.nLiqHe = daughter->GetMultiplicity();
+            pending.push_back(daughter->GetLogicalVolume());
+        }
+    }
+
+    // the walls of the Si block of a parameterised grid are found from X
+    if (shape.placement == "param")
+    {
+        shape.SiDimX = (shape.worldDimX - shape.nLiqHe * gapDimX) / (shape.nLiqHe + 1);
+        shape.pitch = shape.SiDimX + gapDimX;
+    }
+    shape.hex = (shape.placement == "lattice" && nPostsInCell == 2);
+}
+
+void sisfeVolumeRegistry::Forget(const G4LogicalVolume *logic)
+{
+    m_types.erase(logic);
+    m_grids.erase(logic);
+    m_users.erase(logic);
+    for (auto &users : m_users)
+        users.second.erase(logic);
+    for (auto pillar = m_pillars.begin(); pillar != m_pillars.end();)
+    {
+        if (pillar->second == logic)
+            pillar = m_pillars.erase(pillar);
+        else
+            ++pillar;
+    }
+}
+
+void sisfeVolumeRegistry::Clear()
+{
+    m_types.clear();
+    m_grids.clear();
+    m_users.clear();
+    m_pillars.clear();
+}
+
+G4bool sisfeVolumeRegistry::IsShared(const G4LogicalVolume *logic) const
+{
+    const auto found = m_users.find(logic);
+    return found != m_users.end() && found->second.size() > 1;
+}
+
+G4LogicalVolume *sisfeVolumeRegistry::FindPillar(const sisfePillarKey &key) const
+{
+    const auto found = m_pillars.find(key);
+    return (found == m_pillars.end()) ? nullptr : found->second;
+}
+
+void sisfeVolumeRegistry::AddPillar(const sisfePillarKey &key, G4LogicalVolume *logic)
+{
+    m_pillars[key] = logic;
+}
+
+sisfePillarId sisfeVolumeRegistry::Identify(const G4VTouchable *touchable, const G4ThreeVector &globalPosition) const
+{
+    sisfePillarId id;
+    const auto found = m_types.find(touchable->GetVolume()->GetLogicalVolume());
+    if (found == m_types.end())
+        return id;
+
+    // the grid is the first container above the volume, at most four levels up (a post of a lattice)
+    const sisfeGridShape *shape = nullptr;
+    const auto maxDepth = std::min(touchable->GetHistoryDepth(), 4);
+    for (G4int depth = 0; depth <= maxDepth && !shape; ++depth)
+    {
+        const auto grid = m_grids.find(touchable->GetVolume(depth)->GetLogicalVolume());
+        if (grid != m_grids.end())
+            shape = &grid->second;
+    }
+    if (!shape)
+        return id;
+    const auto &grid = *shape;
+
+    id.type = found->second;
+    id.grid = grid.nameID;
+    if (id.type == sisfeVolumeType::Container)
+        return id;
+
+    const auto local = touchable->GetHistory()->GetTopTransform().TransformPoint(globalPosition);
+    id.localX = local.x();
+    const auto copy = touchable->GetCopyNumber();
+
+    if (grid.placement == "param")
+    {
+        if (id.type == sisfeVolumeType::Si)
+        {
+            // one Si block holds every wall, the points of the block between two gaps belong to one wall
+            id.column = std::min(std::max(G4int(std::floor((local.x() + grid.worldDimX / 2) / grid.pitch)), 0), grid.nLiqHe);
+            id.localX = local.x() - (-grid.worldDimX / 2 + grid.SiDimX / 2 + id.column * grid.pitch);
+        }
+        else
+        {
+            // a LiqHe column sits in the gap of the same index
+            id.column = touchable->GetReplicaNumber(id.type == sisfeVolumeType::LiqHe ? 1 : 0);
+        }
+    }
+    else if (grid.placement == "replica")
+    {
+        // the last Si wall is placed in the container with its column as copy number, the other pillars are in cells
+        if (id.type == sisfeVolumeType::Si && touchable->GetVolume(1)->GetLogicalVolume() == grid.container)
+            id.column = copy;
+        else
+            id.column = touchable->GetReplicaNumber(id.type == sisfeVolumeType::Gap ? 0 : 1);
+    }
+    else if (grid.placement == "lattice")
+    {
+        // cell, row and layer replicas above the post, a hex cell holds the posts of two rows
+        const G4int depth = (id.type == sisfeVolumeType::Si) ? 1 : 0;
+        id.column = touchable->GetReplicaNumber(depth);
+        id.row = touchable->GetReplicaNumber(depth + 1);
+        id.layer = touchable->GetReplicaNumber(depth + 2);
+        if (grid.hex)
+            id.row = 2 * id.row + ((id.type == sisfeVolumeType::Si) ? copy : (local.y() > 0. ? 1 : 0));
+    }
+    else
+    {
+        // Si walls have the even and LiqHe columns the odd copy numbers
+        id.column = copy / 2;
+    }
+    return id;
+}
+
 const G4VPhysicalVolume *sisfeGeometry::GetPhysicalVolumeContainer()
 {
     return m_physContainer;
@@ -0,0 +1,18 @@
+#include "musigSisfeParameterisation.h"
+
+namespace MuSiG {
+
+sisfePillarParameterisation::sisfePillarParameterisation(G4double start, G4double pitch, G4double offsetY)
+    : m_start(start), m_pitch(pitch), m_offsetY(offsetY)
+{
+}
+
+sisfePillarParameterisation::~sisfePillarParameterisation() {}
+
+void sisfePillarParameterisation::ComputeTransformation(const G4int copyNo, G4VPhysicalVolume *physVol) const
+{
+    physVol->SetTranslation(G4ThreeVector(m_start + copyNo * m_pitch, m_offsetY, 0.));
+    physVol->SetRotation(nullptr);
+}
+
+}
@@ -0,0 +1,244 @@
+#include "musigStoppingScorer.h"
+
+#include <G4AutoLock.hh>
+#include <G4Box.hh>
+#include <G4LogicalVolume.hh>
+#include <G4NavigationHistory.hh>
+#include <G4ParticleDefinition.hh>
+#include <G4Step.hh>
+#include <G4StepPoint.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4Track.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4VTouchable.hh>
+#include <G4ios.hh>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+
+namespace MuSiG {
+
+
+    namespace {
+
+        G4Mutex scorersMutex = G4MUTEX_INITIALIZER;
+
+        G4bool IsMuon(const G4String &particle) {
+            return (particle == "mu+") || (particle == "mu-") || (particle == "Mu");
+        }
+
+    }
+
+
+    std::vector<StoppingScorer *> &StoppingScorer::Scorers() {
+        static std::vector<StoppingScorer *> scorers;
+        return scorers;
+    }
+
+
+    StoppingScorer::StoppingScorer(const G4String &name, const StoppingHistogramDefinition &histogram)
+            : G4VSensitiveDetector(name), fHistogram(histogram) {
+        if (!fHistogram.container.empty()) {
+            fCounts.nX = fHistogram.nX;
+            fCounts.nY = fHistogram.nY;
+            fCounts.nZ = fHistogram.nZ;
+            fCounts.histogram.assign(std::size_t(fHistogram.nX * fHistogram.nY * fHistogram.nZ), 0);
+        }
+        G4AutoLock lock(&scorersMutex);
+        Scorers().push_back(this);
+    }
+
+
+    StoppingScorer::~StoppingScorer() {
+        G4AutoLock lock(&scorersMutex);
+        auto &scorers = Scorers();
+        scorers.erase(std::remove(scorers.begin(), scorers.end(), this), scorers.end());
+    }
+
+
+    G4bool StoppingScorer::IsStop(G4TrackStatus trackStatus, G4StepStatus stepStatus, G4double kineticEnergy) {
+        // the decay or capture of a muon already at rest comes in an at-rest step of its own (fStopAndKill, no
+        // kinetic energy), it is the same stop
+        if (stepStatus == fAtRestDoItProc) {
+            return false;
+        }
+        // at rest (decay or capture follows) or killed without kinetic energy; decays in flight are not stops
+        return (trackStatus == fStopButAlive) || ((trackStatus == fStopAndKill) && (kineticEnergy <= 0.));
+    }
+
+
+    G4bool StoppingScorer::ProcessHits(G4Step *step, G4TouchableHistory *) {
+        auto track = step->GetTrack();
+        auto postStep = step->GetPostStepPoint();
+
+        if (!IsStop(track->GetTrackStatus(), postStep->GetStepStatus(), postStep->GetKineticEnergy()) ||
+            !IsMuon(track->GetDefinition()->GetParticleName())) {
+            return false;
+        }
+
+        auto touchable = step->GetPreStepPoint()->GetTouchable();
+        std::string volume = touchable->GetVolume()->GetLogicalVolume()->GetName();
+        auto copy = touchable->GetCopyNumber();
+        if (fPillars) {
+            // a pillar volume may be shared by several grids, its stops are counted under the name of the grid
+            const auto pillar = fPillars->Identify(touchable, postStep->GetPosition());
+            if ((pillar.type == sisfeVolumeType::Si) || (pillar.type == sisfeVolumeType::LiqHe)) {
+                copy = pillar.column;
+                volume = pillar.grid + ((pillar.type == sisfeVolumeType::Si) ? "logicSi" : "logicLiqHe");
+            }
+        }
+        ++fCounts.volumes[std::make_pair(volume, copy)];
+        ++fCounts.total;
+
+        if (fHistogram.container.empty()) {
+            return true;
+        }
+
+        // position in the frame of the container, found in the touchable history
+        const auto depth = touchable->GetHistoryDepth();
+        for (G4int i = 0; i <= depth; ++i) {
+            auto logic = touchable->GetVolume(i)->GetLogicalVolume();
+            if (logic->GetName() != fHistogram.container) {
+                continue;
+            }
+            auto box = dynamic_cast<const G4Box *>(logic->GetSolid());
+            if (!box) {
+                break;
+            }
+            fCounts.halfSize = G4ThreeVector(box->GetXHalfLength(), box->GetYHalfLength(), box->GetZHalfLength());
+
+            const auto local = touchable->GetHistory()->GetTransform(depth - i).TransformPoint(postStep->GetPosition());
+            auto bin = [](G4double x, G4double half, G4int n) {
+                return std::min(n - 1, std::max(0, G4int((x + half) / (2. * half) * n)));
+            };
+            const auto ix = bin(local.x(), fCounts.halfSize.x(), fHistogram.nX);
+            const auto iy = bin(local.y(), fCounts.halfSize.y(), fHistogram.nY);
+            const auto iz = bin(local.z(), fCounts.halfSize.z(), fHistogram.nZ);
+            ++fCounts.histogram[std::size_t((iz * fHistogram.nY + iy) * fHistogram.nX + ix)];
+            break;
+        }
+        return true;
+    }
+
+
+    StoppingCounts StoppingScorer::Merge() {
+        G4AutoLock lock(&scorersMutex);
+        StoppingCounts merged;
+        for (auto scorer: Scorers()) {
+            const auto &counts = scorer->fCounts;
+            for (const auto &volume: counts.volumes) {
+                merged.volumes[volume.first] += volume.second;
+            }
+            if (merged.histogram.empty() && !counts.histogram.empty()) {
+                merged.histogram.assign(counts.histogram.size(), 0);
+                merged.nX = counts.nX;
+                merged.nY = counts.nY;
+                merged.nZ = counts.nZ;
+            }
+            for (std::size_t i = 0; i < counts.histogram.size(); ++i) {
+                merged.histogram[i] += counts.histogram[i];
+            }
+            if (counts.halfSize.mag2() > 0.) {
+                merged.halfSize = counts.halfSize;
+            }
+            merged.total += counts.total;
+        }
+        return merged;
+    }
+
+
+    void StoppingScorer::Reset() {
+        G4AutoLock lock(&scorersMutex);
+        for (auto scorer: Scorers()) {
+            scorer->fCounts.volumes.clear();
+            std::fill(scorer->fCounts.histogram.begin(), scorer->fCounts.histogram.end(), 0);
+            scorer->fCounts.total = 0;
+        }
+    }
+
+
+    void StoppingScorer::Print() {
+        const auto counts = Merge();
+        G4cout << G4endl << "########## Muon stops: " << counts.total << G4endl;
+        G4cout << std::setw(32) << "volume" << std::setw(8) << "copy" << std::setw(12) << "stops" << std::setw(10)
+               << "%" << G4endl;
+        for (const auto &volume: counts.volumes) {
+            G4cout << std::setw(32) << volume.first.first << std::setw(8) << volume.first.second << std::setw(12)
+                   << volume.second << std::setw(10) << std::fixed << std::setprecision(3)
+                   << 100. * G4double(volume.second) / G4double(counts.total) << G4endl;
+        }
+        G4cout << std::defaultfloat;
+
+        if (counts.histogram.empty()) {
+            return;
+        }
+
+        // projections of the histogram on the axes of the container
+        std::vector<G4long> projection[3] = {std::vector<G4long>(std::size_t(counts.nX), 0),
+                                             std::vector<G4long>(std::size_t(counts.nY), 0),
+                                             std::vector<G4long>(std::size_t(counts.nZ), 0)};
+        for (G4int iz = 0; iz < counts.nZ; ++iz) {
+            for (G4int iy = 0; iy < counts.nY; ++iy) {
+                for (G4int ix = 0; ix < counts.nX; ++ix) {
+                    const auto n = counts.histogram[std::size_t((iz * counts.nY + iy) * counts.nX + ix)];
+                    projection[0][std::size_t(ix)] += n;
+                    projection[1][std::size_t(iy)] += n;
+                    projection[2][std::size_t(iz)] += n;
+                }
+            }
+        }
+
+        const char *axes[3] = {"X", "Y", "Z"};
+        for (G4int axis = 0; axis < 3; ++axis) {
+            const auto half = counts.halfSize[axis];
+            const auto &bins = projection[axis];
+            G4cout << "---------- stops along " << axes[axis] << " of the container [mm]" << G4endl;
+            for (std::size_t i = 0; i < bins.size(); ++i) {
+                const auto centre = -half + (G4double(i) + 0.5) * 2. * half / G4double(bins.size());
+                G4cout << std::setw(14) << centre / mm << std::setw(12) << bins[i] << G4endl;
+            }
+        }
+    }
+
+
+    void StoppingScorer::Write(const G4String &fileName) {
+        const auto counts = Merge();
+        std::ofstream file(fileName);
+        if (!file) {
+            G4cout << "<><><><><> ERROR: stopping file " << fileName << " cannot be written" << G4endl;
+            exit(1);
+        }
+
+        file << "# muon stops per volume\n# volume,copy,stops (copy is the column for sisfe pillars)\n";
+        for (const auto &volume: counts.volumes) {
+            file << volume.first.first << "," << volume.first.second << "," << volume.second << "\n";
+        }
+        file << "# total," << counts.total << "\n";
+
+        if (counts.histogram.empty()) {
+            return;
+        }
+        file << "# stops in the container, bin centres in mm\n# ix,iy,iz,x,y,z,stops\n";
+        const G4ThreeVector width(2. * counts.halfSize.x() / counts.nX, 2. * counts.halfSize.y() / counts.nY,
+                                  2. * counts.halfSize.z() / counts.nZ);
+        for (G4int iz = 0; iz < counts.nZ; ++iz) {
+            for (G4int iy = 0; iy < counts.nY; ++iy) {
+                for (G4int ix = 0; ix < counts.nX; ++ix) {
+                    const auto n = counts.histogram[std::size_t((iz * counts.nY + iy) * counts.nX + ix)];
+                    if (n == 0) {
+                        continue;
+                    }
+                    const auto x = -counts.halfSize.x() + (ix + 0.5) * width.x();
+                    const auto y = -counts.halfSize.y() + (iy + 0.5) * width.y();
+                    const auto z = -counts.halfSize.z() + (iz + 0.5) * width.z();
+                    file << ix << "," << iy << "," << iz << "," << x / mm << "," << y / mm << "," << z / mm << ","
+                         << n << "\n";
+                }
+            }
+        }
+    }
+
+
+}
@@ -0,0 +1,152 @@
+#include "musigThreadOutput.h"
+
+#include <G4Threading.hh>
+#include <G4ios.hh>
+
+#include <cstdio>
+#include <memory>
+
+
+namespace MuSiG {
+
+
+    namespace {
+
+        // chunk of one event in a part file: event ID, size of the data, data
+        typedef struct EventHeader {
+            std::int32_t eventID;
+            std::uint64_t size;
+        } EventHeader;
+
+        typedef struct PartReader {
+            std::ifstream file;
+            EventHeader header{};
+            G4bool valid = false;
+
+            void Next() {
+                valid = static_cast<G4bool>(file.read(reinterpret_cast<char *>(&header), sizeof(EventHeader)));
+            }
+        } PartReader;
+
+    }
+
+
+    ThreadOutput *ThreadOutput::Instance() {
+        static G4ThreadLocal ThreadOutput *instance = nullptr;
+        if (!instance) {
+            instance = new ThreadOutput();
+        }
+        return instance;
+    }
+
+
+    G4String ThreadOutput::PartName(const G4String &fileName, G4int threadID) {
+        // the master of a sequential run has the ID -1
+        return fileName + ".part" + std::to_string(threadID + 1);
+    }
+
+
+    void ThreadOutput::BeginRun(const G4String &fileName) {
+        fPartName = PartName(fileName, G4Threading::G4GetThreadId());
+        fPart.open(fPartName, std::ios::binary | std::ios::trunc);
+        if (!fPart) {
+            G4cout << "<><><><><> ERROR: output part file " << fPartName << " cannot be written" << G4endl;
+            exit(1);
+        }
+        fChunk.clear();
+        fChunk.reserve(fChunkSize + fChunkSize / 4);
+    }
+
+
+    void ThreadOutput::BeginEvent(G4int eventID) {
+        fEventID = eventID;
+        fEvent.str("");
+        fEvent.clear();
+    }
+
+
+    void ThreadOutput::EndEvent() {
+        const auto data = fEvent.str();
+        if (data.empty()) {
+            return;
+        }
+
+        const EventHeader header{fEventID, data.size()};
+        const auto bytes = reinterpret_cast<const char *>(&header);
+        fChunk.insert(fChunk.end(), bytes, bytes + sizeof(EventHeader));
+        fChunk.insert(fChunk.end(), data.begin(), data.end());
+
+        if (fChunk.size() >= fChunkSize) {
+            Flush();
+        }
+    }
+
+
+    void ThreadOutput::Flush() {
+        fPart.write(fChunk.data(), std::streamsize(fChunk.size()));
+        fChunk.clear();
+    }
+
+
+    void ThreadOutput::EndRun() {
+        Flush();
+        fPart.close();
+    }
+
+
+    G4long ThreadOutput::Merge(const G4String &fileName, const G4String &header) {
+        std::vector<std::unique_ptr<PartReader>> parts;
+        std::vector<G4String> partNames;
+        // -1 for the sequential master, the worker IDs are contiguous from 0
+        for (G4int threadID = -1;; ++threadID) {
+            const auto partName = PartName(fileName, threadID);
+            auto part = std::unique_ptr<PartReader>(new PartReader());
+            part->file.open(partName, std::ios::binary);
+            if (!part->file) {
+                if (threadID < 0) {
+                    continue;
+                }
+                break;
+            }
+            part->Next();
+            parts.push_back(std::move(part));
+            partNames.push_back(partName);
+        }
+
+        std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            G4cout << "<><><><><> ERROR: output file " << fileName << " cannot be written" << G4endl;
+            exit(1);
+        }
+        out << header;
+
+        // the events of one thread are in increasing order, the next event is the smallest head of the parts
+        G4long nEvents = 0;
+        std::vector<char> data;
+        for (;;) {
+            PartReader *next = nullptr;
+            for (const auto &part: parts) {
+                if (part->valid && (!next || (part->header.eventID < next->header.eventID))) {
+                    next = part.get();
+                }
+            }
+            if (!next) {
+                break;
+            }
+
+            data.resize(next->header.size);
+            next->file.read(data.data(), std::streamsize(data.size()));
+            out.write(data.data(), std::streamsize(data.size()));
+            ++nEvents;
+            next->Next();
+        }
+
+        parts.clear();
+        for (const auto &partName: partNames) {
+            std::remove(partName.c_str());
+        }
+        return nEvents;
+    }
+
+
+}
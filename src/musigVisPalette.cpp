@@ -0,0 +1,98 @@
+#include "musigVisPalette.h"
+
+#include <G4AutoLock.hh>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace MuSiG {
+
+
+    VisPalette &VisPalette::Instance() {
+        static VisPalette palette;
+        return palette;
+    }
+
+
+    G4bool VisPalette::Parse(const G4String &colour, G4Colour &result, G4bool &visible) {
+        visible = true;
+
+        if (colour.find(',') != std::string::npos) {
+            std::vector<G4double> components;
+            std::istringstream is(colour);
+            std::string item;
+            while (std::getline(is, item, ',')) {
+                char *end = nullptr;
+                const auto value = std::strtod(item.c_str(), &end);
+                if (item.empty() || (*end != '\0') || (value < 0.) || (value > 1.)) {
+                    return false;
+                }
+                components.push_back(value);
+            }
+            if ((components.size() != 3) && (components.size() != 4)) {
+                return false;
+            }
+            result = G4Colour(components[0], components[1], components[2],
+                              (components.size() == 4) ? components[3] : 1.);
+            return true;
+        }
+
+        std::string name(colour);
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (name == "red") {
+            result = G4Colour(1.0, 0.2, 0.2);
+        } else if (name == "blue") {
+            result = G4Colour(0.0, 127, 255);
+        } else if (name == "green") {
+            result = G4Colour(0.5, 1.0, 0.5);
+        } else if (name == "yellow") {
+            result = G4Colour(1.0, 1.0, 0.);
+        } else if (name == "magenta") {
+            result = G4Colour(1.0, 0.0, 1.);
+        } else if (name == "white") {
+            result = G4Colour(1, 1, 1);
+        } else if (name == "invisible") {
+            result = G4Colour(1, 1, 1);
+            visible = false;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+
+    const G4VisAttributes *VisPalette::Get(const G4String &colour) {
+        G4Colour parsed;
+        G4bool visible = true;
+        if (!Parse(colour, parsed, visible)) {
+            return nullptr;
+        }
+        return Get(parsed, visible);
+    }
+
+
+    const G4VisAttributes *VisPalette::Get(const G4Colour &colour, G4bool visible) {
+        const auto key = std::make_tuple(colour.GetRed(), colour.GetGreen(), colour.GetBlue(), colour.GetAlpha(),
+                                         visible);
+        G4AutoLock lock(&fMutex);
+        auto &attributes = fAttributes[key];
+        if (!attributes) {
+            attributes.reset(new G4VisAttributes(colour));
+            attributes->SetVisibility(visible);
+        }
+        return attributes.get();
+    }
+
+
+    std::size_t VisPalette::Size() const {
+        G4AutoLock lock(&fMutex);
+        return fAttributes.size();
+    }
+
+
+}
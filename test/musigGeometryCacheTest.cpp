@@ -0,0 +1,99 @@
+/// Test of the GDML geometry cache: a world read back from the cache has one material of each name, the one its
+/// volumes use, as the definitions only check the material names and do not build them.
+///
+/// Build against Geant4 with GDML and zlib, e.g.
+///     g++ -std=c++17 -Iinclude -Itest test/musigGeometryCacheTest.cpp src/*.cpp
+///         $(geant4-config --cflags --libs) -lz -o musigGeometryCacheTest
+
+#include "musigDetectorConstruction.h"
+#include "musigGeometryCache.h"
+#include "musigTest.h"
+
+#include <G4LogicalVolumeStore.hh>
+#include <G4Material.hh>
+#include <G4RunManager.hh>
+#include <G4UImanager.hh>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+
+
+namespace {
+
+    const char *kMacro = "musigGeometryCacheTest.mac";
+    const char *kCacheDirectory = "musigGeometryCacheTest.d";
+
+    void WriteMacro() {
+        std::ofstream macro(kMacro);
+        macro << "/setup/geometryCache " << kCacheDirectory << "\n"
+              << "/setup/worldsize 500 500 500 mm\n"
+              << "/setup/box Plate G4_Cu 10. 31. 62. mm 20 0. 0 mm 0 0 0 World A\n"
+              << "/setup/tubs Ring Copper 1 2 30 mm -20 0 0 mm 0 0 0 World A\n"
+              << "/setup/sisfe SfHeTarget 10 0.04 28.999 0.08 mm 0.01 28.999 0.08 mm 0.04 0. 0. mm 0 90 0 World\n";
+    }
+
+    void Construct() {
+        MuSiG::DetectorConstruction detector;
+        G4UImanager::GetUIpointer()->ApplyCommand(G4String("/control/execute ") + kMacro);
+        detector.Construct();
+    }
+
+    std::size_t CacheFiles() {
+        std::size_t files = 0;
+        for (const auto &entry: std::filesystem::directory_iterator(kCacheDirectory)) {
+            files += (entry.path().extension() == ".gdml") ? 1 : 0;
+        }
+        return files;
+    }
+
+}
+
+
+int main() {
+    if (!MuSiG::GeometryCache::IsAvailable()) {
+        std::cout << "musigGeometryCacheTest: Geant4 without GDML, skipped" << std::endl;
+        return 0;
+    }
+
+    auto runManager = new G4RunManager;
+    WriteMacro();
+    std::filesystem::remove_all(kCacheDirectory);
+    std::filesystem::create_directory(kCacheDirectory);
+
+    // the first build writes the cache in a child process, so that none of its materials are left here
+    MUSIG_CHECK(!MuSiG::Test::Exits(Construct));
+    MUSIG_CHECK(CacheFiles() == 1);
+
+    {
+        MuSiG::DetectorConstruction detector;
+        G4UImanager::GetUIpointer()->ApplyCommand(G4String("/control/execute ") + kMacro);
+        MUSIG_CHECK(G4Material::GetMaterialTable()->empty());
+        detector.Construct();
+        MUSIG_CHECK(CacheFiles() == 1);
+
+        std::map<std::string, G4int> materials;
+        for (const auto mat: *G4Material::GetMaterialTable()) {
+            ++materials[mat->GetName()];
+        }
+        for (const auto &material: materials) {
+            if (material.second != 1) {
+                std::cout << "material " << material.first << " built " << material.second << " times" << std::endl;
+            }
+            MUSIG_CHECK(material.second == 1);
+        }
+        for (const char *name: {"G4_Cu", "Copper", "LiqHe", "G4_Si", "Galactic"}) {
+            MUSIG_CHECK(materials.count(name) == 1);
+        }
+
+        auto plate = G4LogicalVolumeStore::GetInstance()->GetVolume("Plate", false);
+        MUSIG_CHECK(plate && (plate->GetMaterial() == G4Material::GetMaterial("G4_Cu", false)));
+    }
+
+    std::filesystem::remove_all(kCacheDirectory);
+    std::remove(kMacro);
+    delete runManager;
+    return MuSiG::Test::Result("musigGeometryCacheTest");
+}
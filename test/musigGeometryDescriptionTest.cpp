@@ -0,0 +1,140 @@
+/// Test of /setup/compile and /setup/load: a macro compiled and loaded gives the definitions of the macro run as
+/// commands, and a file of another version or cut short is rejected.
+///
+/// Build against Geant4 and zlib, e.g.
+///     g++ -std=c++17 -Iinclude -Itest test/musigGeometryDescriptionTest.cpp src/*.cpp
+///         $(geant4-config --cflags --libs) -lz -o musigGeometryDescriptionTest
+
+#include "musigDetectorConstruction.h"
+#include "musigGeometryDescription.h"
+#include "musigTest.h"
+
+#include <G4RunManager.hh>
+#include <G4UImanager.hh>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+
+namespace {
+
+    const char *kMacro = "musigGeometryDescriptionTest.mac";
+    const char *kIncluded = "musigGeometryDescriptionTest-included.mac";
+    const char *kCompiled = "musigGeometryDescriptionTest.msgd";
+    const char *kBadFile = "musigGeometryDescriptionTest-bad.msgd";
+
+    /// definitions of the test macro as set by the commands or by the compiled file
+    struct Definitions {
+        MuSiG::DetShapeDefinition plate;
+        MuSiG::DetShapeDefinition ring;
+        MuSiG::SisfeGeometryDefinition grid;
+    };
+
+    Definitions Get(const MuSiG::DetectorConstruction &detector) {
+        Definitions defs;
+        const auto plate = detector.GetShapeDefinition("Plate");
+        const auto ring = detector.GetShapeDefinition("Ring");
+        const auto grid = detector.GetSisfe("SfHeTarget");
+        MUSIG_CHECK(plate && ring && grid);
+        if (plate && ring && grid) {
+            defs.plate = *plate;
+            defs.ring = *ring;
+            defs.grid = *grid;
+        }
+        return defs;
+    }
+
+    G4bool Same(const MuSiG::DetShapeDefinition &a, const MuSiG::DetShapeDefinition &b) {
+        return (a.shape == b.shape) && (a.params.name == b.params.name) && (a.params.mat == b.params.mat) &&
+               (a.params.size == b.params.size) && (a.params.pos == b.params.pos) && (a.params.rot == b.params.rot) &&
+               (a.params.mother == b.params.mother) && (a.params.booltype == b.params.booltype);
+    }
+
+    G4bool Same(const MuSiG::SisfeGeometryDefinition &a, const MuSiG::SisfeGeometryDefinition &b) {
+        return (a.name == b.name) && (a.nLiqHe == b.nLiqHe) && (a.sizeLiqHe == b.sizeLiqHe) &&
+               (a.sizeSi == b.sizeSi) && (a.pos == b.pos) && (a.rot == b.rot) && (a.mother == b.mother) &&
+               (a.isPlaced == b.isPlaced) && (a.placement == b.placement) && (a.matLiqHe == b.matLiqHe) &&
+               (a.matSi == b.matSi) && (a.matGap == b.matGap);
+    }
+
+    void WriteMacros() {
+        std::ofstream macro(kMacro);
+        macro << "# compiled by musigGeometryDescriptionTest\n"
+              << "/setup/box Plate G4_Cu 10. 31. 62. mm 20 0. 0 mm 0 0 90 World A\n"
+              << "\n"
+              << "/control/execute " << kIncluded << "\n"
+              << "/setup/sisfeMaterials SfHeTarget LiqHe G4_Si\n";
+
+        std::ofstream included(kIncluded);
+        included << "/setup/tubs Ring G4_Cu 1 2 30 mm 0 0 -5 cm 0 0 0 Plate\n"
+                 << "/setup/sisfe SfHeTarget 10 0.04 28.999 0.08 mm 0.01 28.999 0.08 mm 0.04 0. 0. mm 0 90 0 World\n";
+    }
+
+    std::string Load(const char *fileName) {
+        std::ifstream file(fileName, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    G4bool Rejects(const std::string &data) {
+        {
+            std::ofstream file(kBadFile, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), std::streamsize(data.size()));
+        }
+        return MuSiG::Test::Exits([] {
+            MuSiG::DetectorConstruction detector;
+            MuSiG::GeometryDescription::Load(kBadFile, &detector);
+        });
+    }
+
+}
+
+
+int main() {
+    // definitions mark the physics as modified, which needs a run manager
+    auto runManager = new G4RunManager;
+    WriteMacros();
+
+    Definitions commands;
+    {
+        MuSiG::DetectorConstruction detector;
+        G4UImanager::GetUIpointer()->ApplyCommand(G4String("/control/execute ") + kMacro);
+        commands = Get(detector);
+        MuSiG::GeometryDescription::Compile(kMacro, kCompiled);
+    }
+    MUSIG_CHECK(commands.grid.matLiqHe == "LiqHe");
+    MUSIG_CHECK(commands.ring.params.booltype == "A");
+
+    {
+        MuSiG::DetectorConstruction detector;
+        MuSiG::GeometryDescription::Load(kCompiled, &detector);
+        const auto loaded = Get(detector);
+        MUSIG_CHECK(Same(loaded.plate, commands.plate));
+        MUSIG_CHECK(Same(loaded.ring, commands.ring));
+        MUSIG_CHECK(Same(loaded.grid, commands.grid));
+    }
+
+    const auto data = Load(kCompiled);
+    MUSIG_CHECK(!Rejects(data));
+
+    // the version follows the four bytes of the magic
+    auto otherVersion = data;
+    otherVersion[4] = char(otherVersion[4] + 1);
+    MUSIG_CHECK(Rejects(otherVersion));
+
+    auto otherMagic = data;
+    otherMagic[0] = 'X';
+    MUSIG_CHECK(Rejects(otherMagic));
+
+    MUSIG_CHECK(Rejects(data.substr(0, 6)));
+    MUSIG_CHECK(Rejects(data.substr(0, data.size() / 2)));
+    MUSIG_CHECK(Rejects(data.substr(0, data.size() - 1)));
+
+    std::remove(kMacro);
+    std::remove(kIncluded);
+    std::remove(kCompiled);
+    std::remove(kBadFile);
+    delete runManager;
+    return MuSiG::Test::Result("musigGeometryDescriptionTest");
+}
@@ -0,0 +1,168 @@
+/// Test of the columnar hit output: hits written over several blocks are read back unchanged, and a truncated or
+/// corrupted file is rejected instead of being read as fewer hits.
+///
+/// Build against Geant4 and zlib, e.g.
+///     g++ -std=c++17 -Iinclude -Itest test/musigHitColumnsTest.cpp src/musigHitColumns.cpp
+///         $(geant4-config --cflags --libs) -lz -o musigHitColumnsTest
+
+#include "musigHitColumns.h"
+#include "musigTest.h"
+
+#include <G4SystemOfUnits.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+    const char *kFile = "musigHitColumnsTest.mshc";
+    const char *kBadFile = "musigHitColumnsTest-bad.mshc";
+
+    const std::vector<MuSiG::HitColumn> kAllColumns = {
+            MuSiG::HitColumn::EventID, MuSiG::HitColumn::VolumeID, MuSiG::HitColumn::CopyNo,
+            MuSiG::HitColumn::X, MuSiG::HitColumn::Y, MuSiG::HitColumn::Z,
+            MuSiG::HitColumn::Edep, MuSiG::HitColumn::Time};
+
+    /// hits spread over three volumes, the third one first seen in a later block
+    std::vector<MuSiG::HitRecord> MakeHits(std::size_t n) {
+        const char *volumes[] = {"logicSi", "logicLiqHe", "logicMCP"};
+        std::vector<MuSiG::HitRecord> hits(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            auto &hit = hits[i];
+            hit.eventID = G4int(i / 4);
+            hit.volume = volumes[(i < n / 2) ? (i % 2) : (i % 3)];
+            hit.copyNo = G4int(i % 7) - 1;
+            hit.pos = G4ThreeVector(0.25 * G4double(i) * mm, -1.5 * G4double(i) * um, 3. * cm);
+            hit.edep = (1. + G4double(i)) * keV;
+            hit.time = 0.5 * G4double(i) * ns;
+        }
+        return hits;
+    }
+
+    void Write(const std::vector<MuSiG::HitRecord> &hits, std::size_t blockSize) {
+        MuSiG::HitColumnWriter writer(blockSize);
+        writer.Open(kFile);
+        for (const auto &hit: hits) {
+            writer.Add(hit);
+        }
+        writer.Close();
+    }
+
+    G4bool Near(G4double a, G4double b) {
+        return std::abs(a - b) <= 1e-12 * std::max(1., std::abs(b));
+    }
+
+    /// reads every block of the file to the end
+    void ReadAll(const char *fileName) {
+        MuSiG::HitColumnReader reader;
+        reader.Open(fileName);
+        while (reader.ReadBlock(kAllColumns)) {
+        }
+    }
+
+    std::string Load(const char *fileName) {
+        std::ifstream file(fileName, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void Save(const char *fileName, const std::string &data) {
+        std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), std::streamsize(data.size()));
+    }
+
+}
+
+
+int main() {
+    using MuSiG::HitColumn;
+
+    // several full blocks and a partial last one
+    const std::size_t blockSize = 16;
+    const auto hits = MakeHits(3 * blockSize + 5);
+    Write(hits, blockSize);
+
+    {
+        MuSiG::HitColumnReader reader;
+        reader.Open(kFile);
+        std::size_t row = 0;
+        std::size_t blocks = 0;
+        while (reader.ReadBlock(kAllColumns)) {
+            ++blocks;
+            const auto &events = reader.GetInts(HitColumn::EventID);
+            const auto &volumes = reader.GetInts(HitColumn::VolumeID);
+            const auto &copies = reader.GetInts(HitColumn::CopyNo);
+            const auto &x = reader.GetDoubles(HitColumn::X);
+            const auto &y = reader.GetDoubles(HitColumn::Y);
+            const auto &z = reader.GetDoubles(HitColumn::Z);
+            const auto &edep = reader.GetDoubles(HitColumn::Edep);
+            const auto &time = reader.GetDoubles(HitColumn::Time);
+            MUSIG_CHECK(events.size() == reader.GetRows());
+            MUSIG_CHECK(time.size() == reader.GetRows());
+            for (std::size_t i = 0; (i < reader.GetRows()) && (row < hits.size()); ++i, ++row) {
+                const auto &hit = hits[row];
+                MUSIG_CHECK(events[i] == hit.eventID);
+                MUSIG_CHECK(reader.GetVolumeName(volumes[i]) == hit.volume);
+                MUSIG_CHECK(copies[i] == hit.copyNo);
+                MUSIG_CHECK(Near(x[i], hit.pos.x() / mm));
+                MUSIG_CHECK(Near(y[i], hit.pos.y() / mm));
+                MUSIG_CHECK(Near(z[i], hit.pos.z() / mm));
+                MUSIG_CHECK(Near(edep[i], hit.edep / keV));
+                MUSIG_CHECK(Near(time[i], hit.time / ns));
+            }
+        }
+        MUSIG_CHECK(blocks == 4);
+        MUSIG_CHECK(row == hits.size());
+    }
+
+    // only the columns asked for are filled
+    {
+        MuSiG::HitColumnReader reader;
+        reader.Open(kFile);
+        MUSIG_CHECK(reader.ReadBlock({HitColumn::Z}));
+        MUSIG_CHECK(reader.GetDoubles(HitColumn::Z).size() == blockSize);
+        MUSIG_CHECK(reader.GetDoubles(HitColumn::X).empty());
+        MUSIG_CHECK(reader.GetInts(HitColumn::EventID).empty());
+    }
+
+    // an empty file has the end marker only
+    Write({}, blockSize);
+    {
+        MuSiG::HitColumnReader reader;
+        reader.Open(kFile);
+        MUSIG_CHECK(!reader.ReadBlock(kAllColumns));
+        MUSIG_CHECK(reader.GetRows() == 0);
+    }
+
+    Write(hits, blockSize);
+    const auto data = Load(kFile);
+    MUSIG_CHECK(!MuSiG::Test::Exits([] { ReadAll(kFile); }));
+
+    // cut at the end marker, inside the last block and inside the header
+    for (const std::size_t length: {data.size() - 4, data.size() / 2, std::size_t(6)}) {
+        Save(kBadFile, data.substr(0, length));
+        MUSIG_CHECK(MuSiG::Test::Exits([] { ReadAll(kBadFile); }));
+    }
+
+    // the zlib header of the first column: magic, version, number of columns, rows, number of volumes, the two
+    // volume names of the first block, compressed and raw size
+    const std::size_t firstColumn = 4 + 4 + 4 + 4 + 4 + (4 + 7) + (4 + 10) + 8 + 8;
+    auto corrupted = data;
+    corrupted[firstColumn] = char(~corrupted[firstColumn]);
+    Save(kBadFile, corrupted);
+    MUSIG_CHECK(MuSiG::Test::Exits([] { ReadAll(kBadFile); }));
+
+    corrupted = data;
+    corrupted[0] = 'X';
+    Save(kBadFile, corrupted);
+    MUSIG_CHECK(MuSiG::Test::Exits([] { ReadAll(kBadFile); }));
+
+    std::remove(kFile);
+    std::remove(kBadFile);
+    return MuSiG::Test::Result("musigHitColumnsTest");
+}
@@ -0,0 +1,106 @@
+/// Test of the /setup/import table reader: line ends, separators, skipped lines and the rejection of bad rows.
+///
+/// Build against Geant4, e.g.
+///     g++ -std=c++17 -Iinclude -Itest test/musigShapeTableTest.cpp src/musigShapeTable.cpp
+///         $(geant4-config --cflags --libs) -o musigShapeTableTest
+
+#include "musigShapeTable.h"
+#include "musigTest.h"
+
+#include <G4SystemOfUnits.hh>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+    const char *kFile = "musigShapeTableTest.csv";
+
+    const std::string kBox = "box,Plate,G4_Si,10,20,0.5,mm,0,0,1,cm,0,0,90,World";
+    const std::string kTubs = "tubs,Ring,G4_Cu,1,2,30,mm,0,0,-5,mm,0,0,0,Plate,S";
+
+    std::vector<MuSiG::DetShapeDefinition> Read(const std::string &text) {
+        {
+            std::ofstream file(kFile, std::ios::binary | std::ios::trunc);
+            file << text;
+        }
+        return MuSiG::ShapeTable::Read(kFile);
+    }
+
+    G4bool Rejects(const std::string &text) {
+        return MuSiG::Test::Exits([&text] { Read(text); });
+    }
+
+    std::string Tabs(std::string line) {
+        for (auto &c: line) {
+            if (c == ',') {
+                c = '\t';
+            }
+        }
+        return line;
+    }
+
+    /// the two rows of kBox and kTubs, whatever the layout of the file
+    void CheckRows(const std::vector<MuSiG::DetShapeDefinition> &defs) {
+        MUSIG_CHECK(defs.size() == 2);
+        if (defs.size() != 2) {
+            return;
+        }
+        const auto &box = defs[0];
+        MUSIG_CHECK(box.shape == "box");
+        MUSIG_CHECK(box.params.name == "Plate");
+        MUSIG_CHECK(box.params.mat == "G4_Si");
+        MUSIG_CHECK(box.params.size == G4ThreeVector(10. * mm, 20. * mm, 0.5 * mm));
+        MUSIG_CHECK(box.params.pos == G4ThreeVector(0., 0., 1. * cm));
+        MUSIG_CHECK(box.params.rot == G4ThreeVector(0., 0., 90.));
+        MUSIG_CHECK(box.params.mother == "World");
+        MUSIG_CHECK(box.params.booltype == "A");
+
+        const auto &tubs = defs[1];
+        MUSIG_CHECK(tubs.shape == "tubs");
+        MUSIG_CHECK(tubs.params.name == "Ring");
+        MUSIG_CHECK(tubs.params.size == G4ThreeVector(1. * mm, 2. * mm, 30. * mm));
+        MUSIG_CHECK(tubs.params.pos == G4ThreeVector(0., 0., -5. * mm));
+        MUSIG_CHECK(tubs.params.mother == "Plate");
+        MUSIG_CHECK(tubs.params.booltype == "S");
+    }
+
+}
+
+
+int main() {
+    const std::string header = "shape,name,material,sizeX,sizeY,sizeZ,sizeUnit,posX,posY,posZ,posUnit,rotX,rotY,rotZ,"
+                               "mother,booltype";
+
+    CheckRows(Read(kBox + "\n" + kTubs + "\n"));
+    // no newline after the last row
+    CheckRows(Read(kBox + "\n" + kTubs));
+    CheckRows(Read(kBox + "\r\n" + kTubs + "\r\n"));
+    CheckRows(Read(kBox + "\r\n" + kTubs));
+    CheckRows(Read(Tabs(kBox) + "\n" + Tabs(kTubs) + "\n"));
+    CheckRows(Read(Tabs(header) + "\r\n" + Tabs(kBox) + "\r\n" + Tabs(kTubs)));
+    // header, comments, empty and blank lines, spaces around the fields
+    CheckRows(Read(header + "\n# first the plate\n\n" + kBox + "\n   \n\t\n#" + kTubs + "\n" +
+                   "tubs, Ring ,G4_Cu,1,2,30,mm,0,0,-5,mm,0,0,0,Plate,S  \n\n"));
+
+    MUSIG_CHECK(Read("").empty());
+    MUSIG_CHECK(Read("\n\n").empty());
+    MUSIG_CHECK(Read(header + "\n# nothing\n").empty());
+
+    // a header is only skipped on the first line
+    MUSIG_CHECK(Rejects(kBox + "\n" + header + "\n"));
+    MUSIG_CHECK(Rejects("box,Plate,G4_Si,10,2x,0.5,mm,0,0,1,cm,0,0,90,World\n"));
+    MUSIG_CHECK(Rejects("box,Plate,G4_Si,10,,0.5,mm,0,0,1,cm,0,0,90,World\n"));
+    MUSIG_CHECK(Rejects(kBox + "\nbox,Plate,G4_Si,10,20,0.5,mm,0,0,1,parsec,0,0,90,World\n"));
+    MUSIG_CHECK(Rejects("box,Plate,G4_Si,10,20,0.5,mm,0,0,1,cm,0,0,90\n"));
+    MUSIG_CHECK(Rejects(kTubs + ",extra\n"));
+    MUSIG_CHECK(Rejects("cone,Plate,G4_Si,10,20,0.5,mm,0,0,1,cm,0,0,90,World\n"));
+    // the separator is taken from the first row
+    MUSIG_CHECK(Rejects(Tabs(kBox) + "\n" + kTubs + "\n"));
+
+    std::remove(kFile);
+    return MuSiG::Test::Result("musigShapeTableTest");
+}
@@ -0,0 +1,62 @@
+/// Test of the stop rule of StoppingScorer: one count per stopped muon, whatever the steps that follow the stop.
+///
+/// Build against Geant4, e.g.
+///     g++ -std=c++17 -Iinclude -Itest test/musigStoppingScorerTest.cpp src/musigStoppingScorer.cpp src/musigSisfe.cpp
+///         src/musigSisfeParameterisation.cpp src/musigVisPalette.cpp src/musigGeometryArena.cpp
+///         $(geant4-config --cflags --libs) -o musigStoppingScorerTest
+
+#include "musigStoppingScorer.h"
+#include "musigTest.h"
+
+#include <utility>
+#include <vector>
+
+
+namespace {
+
+    struct SdCall {
+        G4TrackStatus track;
+        G4StepStatus step;
+        G4double kineticEnergy;
+    };
+
+    /// stops counted over the steps of one track seen by the scorer
+    G4int Count(const std::vector<SdCall> &calls) {
+        G4int count = 0;
+        for (const auto &call: calls) {
+            if (MuSiG::StoppingScorer::IsStop(call.track, call.step, call.kineticEnergy)) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+}
+
+
+int main() {
+    using MuSiG::StoppingScorer;
+
+    // a mu+ slows down, comes to rest and decays: the last along-step and the at-rest decay step
+    MUSIG_CHECK(Count({{fAlive, fGeomBoundary, 1.},
+                       {fStopButAlive, fAlongStepDoItProc, 0.},
+                       {fStopAndKill, fAtRestDoItProc, 0.}}) == 1);
+
+    // a mu- comes to rest in a step limited by a process and is captured
+    MUSIG_CHECK(Count({{fStopButAlive, fPostStepDoItProc, 0.},
+                       {fStopAndKill, fAtRestDoItProc, 0.}}) == 1);
+
+    // a particle without at-rest process is killed when it runs out of energy
+    MUSIG_CHECK(Count({{fAlive, fAlongStepDoItProc, 1.},
+                       {fStopAndKill, fAlongStepDoItProc, 0.}}) == 1);
+
+    // a decay in flight is not a stop
+    MUSIG_CHECK(Count({{fAlive, fGeomBoundary, 2.},
+                       {fStopAndKill, fPostStepDoItProc, 1.}}) == 0);
+
+    // the at-rest step alone is never a stop
+    MUSIG_CHECK(!StoppingScorer::IsStop(fStopAndKill, fAtRestDoItProc, 0.));
+    MUSIG_CHECK(!StoppingScorer::IsStop(fStopButAlive, fAtRestDoItProc, 0.));
+
+    return MuSiG::Test::Result("musigStoppingScorerTest");
+}
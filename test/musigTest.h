@@ -0,0 +1,58 @@
+#ifndef MUSIG_TEST_H
+#define MUSIG_TEST_H
+
+
+#include <functional>
+#include <iostream>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+/// Checks of the standalone tests in test/: a failed MUSIG_CHECK is printed and counted, and main returns
+/// MuSiG::Test::Result() so that any failure gives a non-zero exit code. See the header of each test for how to
+/// build it.
+
+#define MUSIG_CHECK(condition) MuSiG::Test::Check((condition), #condition, __FILE__, __LINE__)
+
+
+namespace MuSiG {
+
+    namespace Test {
+
+        inline int &Failures() {
+            static int failures = 0;
+            return failures;
+        }
+
+        inline void Check(bool condition, const char *what, const char *file, int line) {
+            if (!condition) {
+                ++Failures();
+                std::cout << "<><><><><> FAILED: " << what << " (" << file << ":" << line << ")" << std::endl;
+            }
+        }
+
+        /// true if what ends the program with an error exit, as the ERROR reports of MuSiG do; it is run in a child
+        /// process so that the test goes on
+        inline bool Exits(const std::function<void()> &what) {
+            std::cout.flush();
+            const auto pid = fork();
+            if (pid == 0) {
+                what();
+                _exit(0);
+            }
+            int status = 0;
+            return (pid > 0) && (waitpid(pid, &status, 0) == pid) && WIFEXITED(status) && (WEXITSTATUS(status) != 0);
+        }
+
+        inline int Result(const char *name) {
+            std::cout << name << ": " << (Failures() ? "FAILED" : "passed") << std::endl;
+            return Failures() ? 1 : 0;
+        }
+
+    }
+
+}
+
+
+#endif
@@ -0,0 +1,95 @@
+/// Test of the per-thread output: events written by three threads, in chunks and with some events empty, are
+/// merged into one file in event order, with nothing lost, and the part files are removed.
+///
+/// Build against Geant4, e.g.
+///     g++ -std=c++17 -Iinclude -Itest test/musigThreadOutputTest.cpp src/musigThreadOutput.cpp
+///         $(geant4-config --cflags --libs) -pthread -o musigThreadOutputTest
+
+#include "musigThreadOutput.h"
+#include "musigTest.h"
+
+#include <G4Threading.hh>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+    const char *kFile = "musigThreadOutputTest.txt";
+    const G4int kThreads = 3;
+    const G4int kEvents = 200;
+
+    /// records of one event, empty for every seventh event (no hits)
+    std::string EventRecords(G4int eventID) {
+        if (eventID % 7 == 3) {
+            return "";
+        }
+        std::string records;
+        for (G4int hit = 0; hit <= eventID % 4; ++hit) {
+            records += std::to_string(eventID) + " " + std::to_string(hit) + " muonium\n";
+        }
+        return records;
+    }
+
+    /// a worker of the event loop: the events are dealt out in turn, as by the run manager
+    void Worker(G4int threadID) {
+        G4Threading::G4SetThreadId(threadID);
+        auto output = MuSiG::ThreadOutput::Instance();
+        // small chunks so that every part file is written in several pieces
+        output->SetChunkSize(256);
+        output->BeginRun(kFile);
+        for (G4int eventID = threadID; eventID < kEvents; eventID += kThreads) {
+            output->BeginEvent(eventID);
+            output->Stream() << EventRecords(eventID);
+            output->EndEvent();
+        }
+        output->EndRun();
+    }
+
+    G4bool Exists(const G4String &fileName) {
+        return static_cast<G4bool>(std::ifstream(fileName));
+    }
+
+}
+
+
+int main() {
+    std::vector<std::thread> workers;
+    for (G4int threadID = 0; threadID < kThreads; ++threadID) {
+        workers.emplace_back(Worker, threadID);
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    for (G4int threadID = 0; threadID < kThreads; ++threadID) {
+        MUSIG_CHECK(Exists(MuSiG::ThreadOutput::PartName(kFile, threadID)));
+    }
+
+    const std::string header = "# event hit volume\n";
+    std::string expected = header;
+    G4long nonEmpty = 0;
+    for (G4int eventID = 0; eventID < kEvents; ++eventID) {
+        const auto records = EventRecords(eventID);
+        expected += records;
+        nonEmpty += records.empty() ? 0 : 1;
+    }
+
+    const auto nEvents = MuSiG::ThreadOutput::Merge(kFile, header);
+    MUSIG_CHECK(nEvents == nonEmpty);
+
+    std::ifstream file(kFile, std::ios::binary);
+    const std::string merged((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    MUSIG_CHECK(merged == expected);
+
+    for (G4int threadID = -1; threadID < kThreads; ++threadID) {
+        MUSIG_CHECK(!Exists(MuSiG::ThreadOutput::PartName(kFile, threadID)));
+    }
+
+    std::remove(kFile);
+    return MuSiG::Test::Result("musigThreadOutputTest");
+}